@@ -0,0 +1,131 @@
+# ---- Benchmark matrix ----
+
+# Builds the benchmark once more for each instruction set and umul128 implementation that the
+# compiler supports, and optionally for AArch64 with a cross toolchain. The run-matrix target runs
+# every build, including the default one, and merges their results into matrix/report.md in the
+# build directory.
+
+include(CheckCXXSourceCompiles)
+
+set(
+    rtz_benchmark_MATRIX_ARGS "--seed=1;--repetitions=5"
+    CACHE STRING "; separated arguments passed to every build of the benchmark matrix"
+)
+set(
+    rtz_benchmark_MATRIX_AARCH64_TOOLCHAIN ""
+    CACHE FILEPATH "Toolchain file for the AArch64 build of the benchmark matrix (none if empty)"
+)
+set(
+    rtz_benchmark_MATRIX_AARCH64_EMULATOR "qemu-aarch64;-L;/usr/aarch64-linux-gnu"
+    CACHE STRING "; separated command running the AArch64 build on the host"
+)
+
+# Lines of the list of builds read by run-matrix.cmake, as matrix_variant(<name> <command>...).
+set(matrix_variants "matrix_variant(default \"$<TARGET_FILE:rtz_benchmark_exe>\")")
+set(matrix_targets rtz_benchmark_exe)
+
+function(add_matrix_variant name)
+  cmake_parse_arguments(PARSE_ARGV 1 arg "" "" "COMPILE_OPTIONS;LINK_OPTIONS;DEFINITIONS")
+  set(target "rtz_benchmark_exe_${name}")
+  add_executable("${target}" source/main.cpp)
+  set_target_properties("${target}" PROPERTIES OUTPUT_NAME "rtz_benchmark_${name}")
+  target_compile_features("${target}" PRIVATE cxx_std_20)
+  target_compile_definitions(
+      "${target}" PRIVATE
+      "RTZ_BENCHMARK_BUILD_VARIANT=\"${name}\"" ${arg_DEFINITIONS}
+  )
+  target_compile_options("${target}" PRIVATE ${arg_COMPILE_OPTIONS})
+  target_link_options("${target}" PRIVATE ${arg_LINK_OPTIONS})
+  target_link_libraries("${target}" PRIVATE rtz_benchmark::rtz Threads::Threads)
+
+  set(
+      matrix_variants
+      "${matrix_variants}\nmatrix_variant(${name} \"$<TARGET_FILE:${target}>\")"
+      PARENT_SCOPE
+  )
+  set(matrix_targets ${matrix_targets} "${target}" PARENT_SCOPE)
+endfunction()
+
+# Whether a program using threads compiles and links with the given flags.
+function(check_matrix_flags result flags)
+  separate_arguments(link_options NATIVE_COMMAND "${flags}")
+  set(CMAKE_REQUIRED_FLAGS "${flags}")
+  set(CMAKE_REQUIRED_LINK_OPTIONS ${link_options})
+  set(CMAKE_REQUIRED_QUIET YES)
+  check_cxx_source_compiles(
+      "#include <thread>\nint main() { std::thread{[] {}}.join(); }"
+      "${result}"
+  )
+endfunction()
+
+add_matrix_variant(generic-umul128 DEFINITIONS RTZ_BENCHMARK_FORCE_GENERIC_UMUL128)
+
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64|i.86)$")
+  if(MSVC)
+    add_matrix_variant(avx2-bmi2 COMPILE_OPTIONS /arch:AVX2)
+  else()
+    check_matrix_flags(rtz_benchmark_HAS_AVX2_BMI2 "-mavx2 -mbmi -mbmi2 -mlzcnt")
+    if(rtz_benchmark_HAS_AVX2_BMI2)
+      add_matrix_variant(avx2-bmi2 COMPILE_OPTIONS -mavx2 -mbmi -mbmi2 -mlzcnt)
+    endif()
+    check_matrix_flags(rtz_benchmark_HAS_M32 "-m32")
+    if(rtz_benchmark_HAS_M32)
+      add_matrix_variant(x86-32 COMPILE_OPTIONS -m32 LINK_OPTIONS -m32)
+    else()
+      message(STATUS "Benchmark matrix: skipping x86-32, -m32 does not link")
+    endif()
+  endif()
+endif()
+
+if(NOT MSVC)
+  check_matrix_flags(rtz_benchmark_HAS_MARCH_NATIVE "-march=native")
+  if(rtz_benchmark_HAS_MARCH_NATIVE)
+    add_matrix_variant(native COMPILE_OPTIONS -march=native)
+  endif()
+endif()
+
+if(NOT rtz_benchmark_MATRIX_AARCH64_TOOLCHAIN STREQUAL "")
+  include(ExternalProject)
+  set(aarch64_binary_dir "${PROJECT_BINARY_DIR}/matrix/aarch64")
+  ExternalProject_Add(
+      rtz_benchmark_matrix_aarch64
+      SOURCE_DIR "${PROJECT_SOURCE_DIR}"
+      BINARY_DIR "${aarch64_binary_dir}"
+      CMAKE_ARGS
+      "-DCMAKE_TOOLCHAIN_FILE=${rtz_benchmark_MATRIX_AARCH64_TOOLCHAIN}"
+      -DCMAKE_BUILD_TYPE=Release
+      -DCMAKE_SKIP_INSTALL_RULES=YES
+      -Drtz_benchmark_BUILD_VARIANT=aarch64
+      INSTALL_COMMAND ""
+      BUILD_ALWAYS YES
+  )
+  set(emulator "")
+  foreach(arg IN LISTS rtz_benchmark_MATRIX_AARCH64_EMULATOR)
+    string(APPEND emulator " \"${arg}\"")
+  endforeach()
+  string(
+      APPEND matrix_variants
+      "\nmatrix_variant(aarch64${emulator} \"${aarch64_binary_dir}/rtz_benchmark\")"
+  )
+  list(APPEND matrix_targets rtz_benchmark_matrix_aarch64)
+endif()
+
+set(matrix_dir "${PROJECT_BINARY_DIR}/matrix")
+file(
+    GENERATE
+    OUTPUT "${matrix_dir}/variants-$<CONFIG>.cmake"
+    CONTENT "${matrix_variants}\n"
+)
+
+add_custom_target(
+    run-matrix
+    COMMAND "${CMAKE_COMMAND}"
+    -D "VARIANTS=${matrix_dir}/variants-$<CONFIG>.cmake"
+    -D "ARGS=${rtz_benchmark_MATRIX_ARGS}"
+    -D "OUTPUT_DIR=${matrix_dir}/$<CONFIG>"
+    -D "MERGE=$<TARGET_FILE:rtz_benchmark_exe>"
+    -P "${PROJECT_SOURCE_DIR}/cmake/run-matrix.cmake"
+    COMMENT "Running the benchmark matrix"
+    VERBATIM
+)
+add_dependencies(run-matrix ${matrix_targets})
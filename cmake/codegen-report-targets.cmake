@@ -0,0 +1,47 @@
+# ---- Codegen report ----
+
+# The codegen-report target disassembles the kernel of every candidate and writes
+# codegen/report.md in the build directory, summarizing the instructions of each kernel next to
+# its llvm-mca estimate and its measured throughput.
+
+find_program(rtz_benchmark_LLVM_MCA NAMES llvm-mca)
+set(
+    CODEGEN_OBJDUMP "${CMAKE_OBJDUMP}"
+    CACHE STRING "objdump used by the codegen-report target"
+)
+set(CODEGEN_NM "${CMAKE_NM}" CACHE STRING "nm used by the codegen-report target")
+set(
+    CODEGEN_MCA_ARGS "-mcpu=native"
+    CACHE STRING "; separated arguments of llvm-mca for the codegen-report target"
+)
+# The kernels are timed through their pointers, which call the out-of-line code the report
+# disassembles, rather than inlined into the measurement loops.
+set(
+    CODEGEN_BENCH_ARGS "--bits=both;--duration=300;--dispatch=function-pointer"
+    CACHE STRING "; separated arguments of rtz_benchmark for the codegen-report target"
+)
+
+if(CODEGEN_OBJDUMP STREQUAL "" OR CODEGEN_NM STREQUAL "")
+  message(STATUS "objdump or nm not found; the codegen-report target is not available")
+  return()
+endif()
+set(mca "")
+if(rtz_benchmark_LLVM_MCA)
+  set(mca "${rtz_benchmark_LLVM_MCA}")
+endif()
+
+add_custom_target(
+    codegen-report
+    COMMAND "${CMAKE_COMMAND}"
+    -D "EXE=$<TARGET_FILE:rtz_benchmark_exe>"
+    -D "OBJDUMP=${CODEGEN_OBJDUMP}"
+    -D "NM=${CODEGEN_NM}"
+    -D "MCA=${mca}"
+    -D "MCA_ARGS=${CODEGEN_MCA_ARGS}"
+    -D "BENCH_ARGS=${CODEGEN_BENCH_ARGS}"
+    -D "OUTPUT_DIR=${PROJECT_BINARY_DIR}/codegen"
+    -P "${PROJECT_SOURCE_DIR}/cmake/codegen-report.cmake"
+    COMMENT "Writing the codegen report"
+    VERBATIM
+)
+add_dependencies(codegen-report rtz_benchmark_exe)
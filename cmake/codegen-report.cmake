@@ -0,0 +1,189 @@
+cmake_minimum_required(VERSION 3.14)
+
+# Disassembles the kernel of every candidate of EXE, summarizes it, and writes OUTPUT_DIR/report.md
+# with the static throughput estimated by llvm-mca (if MCA is set) next to the median throughput
+# measured by EXE with BENCH_ARGS. The disassembly of each kernel goes to OUTPUT_DIR/disassembly.
+
+macro(default name)
+  if(NOT DEFINED "${name}")
+    set("${name}" "${ARGN}")
+  endif()
+endmacro()
+
+default(OBJDUMP objdump)
+default(NM nm)
+default(MCA "")
+default(MCA_ARGS "")
+default(BENCH_ARGS "")
+foreach(var EXE OUTPUT_DIR)
+  if(NOT DEFINED "${var}")
+    message(FATAL_ERROR "${var} must be defined")
+  endif()
+endforeach()
+
+function(run)
+  execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE output)
+  if(NOT result STREQUAL "0")
+    message(FATAL_ERROR "'${ARGN}' failed (${result})")
+  endif()
+  set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+file(REMOVE_RECURSE "${OUTPUT_DIR}/disassembly")
+file(MAKE_DIRECTORY "${OUTPUT_DIR}/disassembly")
+
+# ---- Measured throughput ----
+
+set(csv "${OUTPUT_DIR}/measured.csv")
+message(STATUS "Measuring the candidates")
+run("${EXE}" ${BENCH_ARGS} --measure=throughput "--csv=${csv}")
+file(STRINGS "${csv}" csv_lines REGEX "^[0-9]+,")
+set(
+    csv_pattern
+    "^([0-9]+),[0-9]+,[0-9]+,(\"([^\"]|\"\")*\"|[^,]*),throughput,[0-9]+,([^,]*),"
+)
+foreach(line IN LISTS csv_lines)
+  if(line MATCHES "${csv_pattern}")
+    set(bits "${CMAKE_MATCH_1}")
+    set(name "${CMAKE_MATCH_2}")
+    set(median "${CMAKE_MATCH_4}")
+    if(name MATCHES "^\"(.*)\"$")
+      string(REPLACE "\"\"" "\"" name "${CMAKE_MATCH_1}")
+    endif()
+    string(REGEX REPLACE "^([0-9]+\\.[0-9][0-9])[0-9]*$" "\\1" median "${median}")
+    set("measured_${bits}_${name}" "${median}")
+  endif()
+endforeach()
+
+# ---- Symbols of the kernels ----
+
+run("${EXE}" ${BENCH_ARGS} --list-kernels)
+string(REGEX MATCHALL "[0-9]+\t-?0x[0-9a-f]+\t[^\n]*" kernels "${output}")
+
+run("${NM}" -S -C --defined-only "${EXE}")
+set(symbols "\n${output}")
+if(NOT symbols MATCHES "\n([0-9a-f]+) [0-9a-f]+ T rtz_benchmark_kernel_address_anchor\n")
+  message(FATAL_ERROR "rtz_benchmark_kernel_address_anchor not found in ${EXE}")
+endif()
+set(anchor "0x${CMAKE_MATCH_1}")
+
+# ---- Report ----
+
+run("${OBJDUMP}" -f "${EXE}")
+set(is_x86 NO)
+if(output MATCHES "x86-64|i386")
+  set(is_x86 YES)
+endif()
+
+string(
+    CONCAT report
+    "| bits | candidate | symbol | instructions | multiplications | conditional branches | "
+    "conditional moves and sets | llvm-mca cycles | measured ns |\n"
+    "|---:|---|---|---:|---:|---:|---:|---:|---:|\n"
+)
+
+foreach(kernel IN LISTS kernels)
+  string(REGEX MATCH "^([0-9]+)\t(-?)(0x[0-9a-f]+)\t(.*)$" kernel "${kernel}")
+  set(bits "${CMAKE_MATCH_1}")
+  set(sign "${CMAKE_MATCH_2}")
+  set(offset "${CMAKE_MATCH_3}")
+  set(name "${CMAKE_MATCH_4}")
+  if(sign STREQUAL "-")
+    math(EXPR address "${anchor} - ${offset}" OUTPUT_FORMAT HEXADECIMAL)
+  else()
+    math(EXPR address "${anchor} + ${offset}" OUTPUT_FORMAT HEXADECIMAL)
+  endif()
+  string(REGEX REPLACE "^0x" "" address "${address}")
+
+  # Functions folded into one may share an address.
+  string(REGEX MATCHALL "\n0*${address} [0-9a-f]+ [TtWw] [^\n]*" matches "${symbols}")
+  if(matches STREQUAL "")
+    message(WARNING "No symbol found for ${name} (${bits}-bit)")
+    continue()
+  endif()
+  list(GET matches 0 first_match)
+  string(REGEX MATCH " ([0-9a-f]+) [TtWw] " unused "${first_match}")
+  math(EXPR stop "0x${address} + 0x${CMAKE_MATCH_1}" OUTPUT_FORMAT HEXADECIMAL)
+  set(symbol "")
+  foreach(match IN LISTS matches)
+    string(REGEX REPLACE "^\n[0-9a-f]+ [0-9a-f]+ [TtWw] " "" match "${match}")
+    if(NOT symbol STREQUAL "")
+      string(APPEND symbol " = ")
+    endif()
+    string(APPEND symbol "${match}")
+  endforeach()
+
+  run("${OBJDUMP}" -d --no-show-raw-insn -C "--start-address=0x${address}" "--stop-address=${stop}"
+      "${EXE}")
+  string(MAKE_C_IDENTIFIER "${bits}-${name}" file_name)
+  file(WRITE "${OUTPUT_DIR}/disassembly/${file_name}.s" "${output}")
+
+  set(instructions 0)
+  set(multiplications 0)
+  set(branches 0)
+  set(selects 0)
+  set(mca_input "")
+  string(REGEX MATCHALL "\n +[0-9a-f]+:\t[^\n]*" lines "${output}")
+  foreach(line IN LISTS lines)
+    string(REGEX REPLACE "^\n +[0-9a-f]+:\t" "" line "${line}")
+    # Comments, e.g. with the targets of RIP-relative operands, and names of branch targets. '#'
+    # starts immediates instead of comments on AArch64.
+    if(is_x86)
+      string(REGEX REPLACE " *#.*$" "" line "${line}")
+    endif()
+    string(REGEX REPLACE " *//.*$" "" line "${line}")
+    string(REGEX REPLACE " *<[^>]*>" "" line "${line}")
+    string(REGEX REPLACE "^((rep[a-z]*|lock|notrack|bnd|data16|cs|ds|rex[.A-Z]*) +)+" "" mnemonic
+                         "${line}")
+    string(REGEX MATCH "^[a-z0-9.]+" mnemonic "${mnemonic}")
+    if(mnemonic MATCHES "^nop" OR line MATCHES "^xchg +%ax,%ax$")
+      continue()
+    endif()
+    math(EXPR instructions "${instructions} + 1")
+    if(mnemonic MATCHES "^(i?mul[bwlq]?|mulx|madd|msub|[su]mulh|[su]mull|[su]m(add|sub)l)$")
+      math(EXPR multiplications "${multiplications} + 1")
+    endif()
+    if((mnemonic MATCHES "^j" AND NOT mnemonic MATCHES "^jmp")
+       OR mnemonic MATCHES "^(b\\.[a-z]+|cbn?z|tbn?z)$")
+      math(EXPR branches "${branches} + 1")
+    endif()
+    if(mnemonic MATCHES "^(cmov[a-z]+|set[a-z]+|csel|csinc|csinv|csneg|cset|csetm)$")
+      math(EXPR selects "${selects} + 1")
+    endif()
+    # llvm-mca estimates the straight-line code, without control flow.
+    if(NOT mnemonic MATCHES "^(j[a-z]*|call[a-z]*|ret[a-z]*|b|bl|br|blr|b\\.[a-z]+|cbn?z|tbn?z)$")
+      string(APPEND mca_input "${line}\n")
+    endif()
+  endforeach()
+
+  set(mca_cycles "-")
+  if(NOT MCA STREQUAL "" AND NOT mca_input STREQUAL "")
+    set(mca_file "${OUTPUT_DIR}/disassembly/${file_name}.mca.s")
+    file(WRITE "${mca_file}" "${mca_input}")
+    execute_process(
+        COMMAND "${MCA}" ${MCA_ARGS} "${mca_file}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE mca_output
+        ERROR_VARIABLE mca_error
+    )
+    if(result STREQUAL "0" AND mca_output MATCHES "Block RThroughput: ([0-9.]+)")
+      set(mca_cycles "${CMAKE_MATCH_1}")
+    else()
+      message(WARNING "llvm-mca failed on ${name} (${bits}-bit): ${mca_error}")
+    endif()
+  endif()
+
+  set(measured "-")
+  if(DEFINED "measured_${bits}_${name}")
+    set(measured "${measured_${bits}_${name}}")
+  endif()
+  string(
+      APPEND report
+      "| ${bits} | ${name} | `${symbol}` | ${instructions} | ${multiplications} | ${branches} | "
+      "${selects} | ${mca_cycles} | ${measured} |\n"
+  )
+endforeach()
+
+file(WRITE "${OUTPUT_DIR}/report.md" "${report}")
+message("${report}")
+message(STATUS "Report written to ${OUTPUT_DIR}/report.md")
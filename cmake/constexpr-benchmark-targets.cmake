@@ -0,0 +1,42 @@
+# ---- Constexpr benchmark ----
+
+# The constexpr-benchmark target times the compilation of source/constexpr_benchmark.cpp for every
+# kernel and writes constexpr-benchmark/report.md in the build directory, comparing how long each
+# kernel takes to trim a table of numbers in constant evaluation.
+
+# The script times the compilations with the microseconds of string(TIMESTAMP), which are only
+# available since CMake 3.23.
+if(CMAKE_VERSION VERSION_LESS "3.23")
+  message(
+      FATAL_ERROR
+      "rtz_benchmark_CONSTEXPR_BENCHMARK requires CMake 3.23 or later, not ${CMAKE_VERSION}"
+  )
+endif()
+
+set(
+    CONSTEXPR_BENCHMARK_TABLE_SIZE 20000
+    CACHE STRING "Number of values trimmed at compile time by the constexpr-benchmark target"
+)
+set(
+    CONSTEXPR_BENCHMARK_REPETITIONS 5
+    CACHE STRING "Number of compilations per kernel of the constexpr-benchmark target"
+)
+
+separate_arguments(constexpr_benchmark_flags NATIVE_COMMAND "${CMAKE_CXX_FLAGS}")
+list(APPEND constexpr_benchmark_flags ${CMAKE_CXX20_STANDARD_COMPILE_OPTION})
+
+add_custom_target(
+    constexpr-benchmark
+    COMMAND "${CMAKE_COMMAND}"
+    -D "COMPILER=${CMAKE_CXX_COMPILER}"
+    -D "COMPILER_ID=${CMAKE_CXX_COMPILER_ID}"
+    -D "FLAGS=${constexpr_benchmark_flags}"
+    -D "INCLUDE_DIR=${PROJECT_SOURCE_DIR}/include"
+    -D "SOURCE=${PROJECT_SOURCE_DIR}/source/constexpr_benchmark.cpp"
+    -D "TABLE_SIZE=${CONSTEXPR_BENCHMARK_TABLE_SIZE}"
+    -D "REPETITIONS=${CONSTEXPR_BENCHMARK_REPETITIONS}"
+    -D "OUTPUT_DIR=${PROJECT_BINARY_DIR}/constexpr-benchmark"
+    -P "${PROJECT_SOURCE_DIR}/cmake/constexpr-benchmark.cmake"
+    COMMENT "Timing the kernels in constant evaluation"
+    VERBATIM
+)
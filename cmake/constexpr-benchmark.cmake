@@ -0,0 +1,163 @@
+cmake_minimum_required(VERSION 3.23)
+
+# Compiles SOURCE (source/constexpr_benchmark.cpp) with COMPILER once per kernel of KERNELS, each
+# time trimming a table of TABLE_SIZE numbers during compilation, and writes OUTPUT_DIR/report.md
+# with the median compile time of each kernel over REPETITIONS runs, net of the baseline, which
+# only builds the table. Every kernel is first checked against the naive one at compile time.
+
+macro(default name)
+  if(NOT DEFINED "${name}")
+    set("${name}" "${ARGN}")
+  endif()
+endmacro()
+
+default(COMPILER_ID "")
+default(FLAGS "")
+default(TABLE_SIZE 20000)
+default(REPETITIONS 5)
+default(
+    KERNELS
+    alg32::baseline alg32::naive alg32::granlund_montgomery alg32::lemire
+    alg32::generalized_granlund_montgomery alg32::naive_2_1 alg32::granlund_montgomery_2_1
+    alg32::lemire_2_1 alg32::generalized_granlund_montgomery_2_1 alg32::naive_branchless
+    alg32::granlund_montgomery_branchless alg32::lemire_branchless
+    alg32::generalized_granlund_montgomery_branchless alg32::ctz_inverse_table
+    alg32::residue_table
+    alg64::baseline alg64::naive alg64::granlund_montgomery alg64::lemire
+    alg64::generalized_granlund_montgomery alg64::naive_2_1 alg64::granlund_montgomery_2_1
+    alg64::lemire_2_1 alg64::generalized_granlund_montgomery_2_1 alg64::naive_8_2_1
+    alg64::granlund_montgomery_8_2_1 alg64::lemire_8_2_1
+    alg64::generalized_granlund_montgomery_8_2_1 alg64::naive_branchless
+    alg64::granlund_montgomery_branchless alg64::lemire_branchless
+    alg64::generalized_granlund_montgomery_branchless alg64::ctz_inverse_table
+    alg64::residue_table alg64::naive_split alg64::granlund_montgomery_split alg64::lemire_split
+    alg64::generalized_granlund_montgomery_split
+)
+foreach(var COMPILER INCLUDE_DIR SOURCE OUTPUT_DIR)
+  if(NOT DEFINED "${var}")
+    message(FATAL_ERROR "${var} must be defined")
+  endif()
+endforeach()
+
+# Only the front end is run, and the default limits on constant evaluation are far below what a
+# large table needs.
+if(COMPILER_ID STREQUAL "MSVC")
+  set(compile_flags /nologo /Zs /constexpr:steps2147483647 /constexpr:loop2147483647)
+  set(define_flag /D)
+  set(include_flag /I)
+elseif(COMPILER_ID MATCHES "Clang")
+  set(compile_flags -fsyntax-only -fconstexpr-steps=2147483647)
+  set(define_flag -D)
+  set(include_flag -I)
+else()
+  set(
+      compile_flags
+      -fsyntax-only -fconstexpr-ops-limit=1099511627776 -fconstexpr-loop-limit=2147483647
+  )
+  set(define_flag -D)
+  set(include_flag -I)
+endif()
+
+function(compile kernel)
+  execute_process(
+      COMMAND "${COMPILER}" ${FLAGS} ${compile_flags} ${ARGN}
+      "${define_flag}RTZ_BENCHMARK_CONSTEXPR_KERNEL=${kernel}"
+      "${define_flag}RTZ_BENCHMARK_CONSTEXPR_TABLE_SIZE=${TABLE_SIZE}"
+      "${include_flag}${INCLUDE_DIR}" "${SOURCE}"
+      RESULT_VARIABLE result
+      OUTPUT_VARIABLE output
+      ERROR_VARIABLE output
+  )
+  if(NOT result STREQUAL "0")
+    message(FATAL_ERROR "Compiling the table of ${kernel} failed (${result}):\n${output}")
+  endif()
+endfunction()
+
+# In microseconds; %f appends the microseconds to the seconds.
+function(now out)
+  string(TIMESTAMP time "%s%f" UTC)
+  set("${out}" "${time}" PARENT_SCOPE)
+endfunction()
+
+function(median out)
+  list(SORT ARGN COMPARE NATURAL)
+  list(LENGTH ARGN size)
+  math(EXPR middle "${size} / 2")
+  list(GET ARGN ${middle} result)
+  if(size MATCHES "[02468]$")
+    math(EXPR before "${middle} - 1")
+    list(GET ARGN ${before} other)
+    math(EXPR result "(${result} + ${other}) / 2")
+  endif()
+  set("${out}" "${result}" PARENT_SCOPE)
+endfunction()
+
+# With 2 decimals, from hundredths.
+function(format_hundredths out hundredths)
+  set(sign "")
+  if(hundredths LESS 0)
+    set(sign "-")
+    math(EXPR hundredths "-(${hundredths})")
+  endif()
+  math(EXPR whole "${hundredths} / 100")
+  math(EXPR fraction "${hundredths} % 100")
+  if(fraction LESS 10)
+    set(fraction "0${fraction}")
+  endif()
+  set("${out}" "${sign}${whole}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+# ---- Measurements ----
+
+# Interleaved, so that a slowdown of the machine affects every kernel alike.
+foreach(kernel IN LISTS KERNELS)
+  if(NOT kernel MATCHES "::baseline$")
+    message(STATUS "Checking ${kernel}")
+    compile("${kernel}" "${define_flag}RTZ_BENCHMARK_CONSTEXPR_CHECK")
+  endif()
+  string(MAKE_C_IDENTIFIER "${kernel}" id)
+  set("times_${id}" "")
+endforeach()
+foreach(repetition RANGE 1 ${REPETITIONS})
+  message(STATUS "Timing the kernels (${repetition}/${REPETITIONS})")
+  foreach(kernel IN LISTS KERNELS)
+    string(MAKE_C_IDENTIFIER "${kernel}" id)
+    now(start)
+    compile("${kernel}")
+    now(stop)
+    math(EXPR elapsed "${stop} - ${start}")
+    list(APPEND "times_${id}" "${elapsed}")
+  endforeach()
+endforeach()
+
+# ---- Report ----
+
+string(
+    CONCAT report
+    "Compile time of a table of ${TABLE_SIZE} trimmed numbers, median of ${REPETITIONS} runs.\n\n"
+    "| bits | kernel | compile ms | net of baseline ms | net us per number |\n"
+    "|---:|---|---:|---:|---:|\n"
+)
+foreach(kernel IN LISTS KERNELS)
+  string(MAKE_C_IDENTIFIER "${kernel}" id)
+  median(time ${times_${id}})
+  string(REGEX MATCH "^alg([0-9]+)::" unused "${kernel}")
+  set(bits "${CMAKE_MATCH_1}")
+  math(EXPR total "${time} / 10")
+  format_hundredths(total "${total}")
+  set(net "-")
+  set(per_number "-")
+  if(DEFINED "times_alg${bits}__baseline" AND NOT kernel MATCHES "::baseline$")
+    median(baseline ${times_alg${bits}__baseline})
+    math(EXPR net_microseconds "${time} - ${baseline}")
+    math(EXPR net "${net_microseconds} / 10")
+    format_hundredths(net "${net}")
+    math(EXPR per_number "${net_microseconds} * 100 / ${TABLE_SIZE}")
+    format_hundredths(per_number "${per_number}")
+  endif()
+  string(APPEND report "| ${bits} | ${kernel} | ${total} | ${net} | ${per_number} |\n")
+endforeach()
+
+file(WRITE "${OUTPUT_DIR}/report.md" "${report}")
+message("${report}")
+message(STATUS "Report written to ${OUTPUT_DIR}/report.md")
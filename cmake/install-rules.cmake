@@ -8,6 +8,18 @@ include(GNUInstallDirs)
 # find_package(<package>) call for consumers to find this project
 set(package rtz_benchmark)
 
+install(
+    DIRECTORY include/
+    DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}"
+    COMPONENT rtz_benchmark_Development
+)
+
+install(
+    TARGETS rtz_benchmark_rtz
+    EXPORT rtz_benchmarkTargets
+    INCLUDES DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}"
+)
+
 install(
     TARGETS rtz_benchmark_exe
     EXPORT rtz_benchmarkTargets
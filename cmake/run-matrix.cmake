@@ -0,0 +1,53 @@
+cmake_minimum_required(VERSION 3.14)
+
+# Runs every build listed in VARIANTS with ARGS, writing the results to OUTPUT_DIR/<name>.csv and
+# the output to OUTPUT_DIR/<name>.txt, and merges the results into OUTPUT_DIR/report.md with
+# MERGE --merge. Builds that fail, e.g. because they cannot run on this host, are left out.
+
+foreach(var VARIANTS OUTPUT_DIR MERGE)
+  if(NOT DEFINED "${var}")
+    message(FATAL_ERROR "${var} must be defined")
+  endif()
+endforeach()
+
+set(variant_names "")
+macro(matrix_variant name)
+  list(APPEND variant_names "${name}")
+  set("command_${name}" ${ARGN})
+endmacro()
+include("${VARIANTS}")
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+set(csv_files "")
+foreach(name IN LISTS variant_names)
+  message(STATUS "Running the ${name} build")
+  set(csv "${OUTPUT_DIR}/${name}.csv")
+  file(REMOVE "${csv}")
+  execute_process(
+      COMMAND ${command_${name}} ${ARGS} "--csv=${csv}"
+      OUTPUT_FILE "${OUTPUT_DIR}/${name}.txt"
+      ERROR_FILE "${OUTPUT_DIR}/${name}.txt"
+      RESULT_VARIABLE result
+  )
+  if(result STREQUAL "0" AND EXISTS "${csv}")
+    list(APPEND csv_files "${csv}")
+  else()
+    message(WARNING "The ${name} build failed (${result}), see ${OUTPUT_DIR}/${name}.txt")
+  endif()
+endforeach()
+
+if(csv_files STREQUAL "")
+  message(FATAL_ERROR "No build of the matrix ran successfully")
+endif()
+string(REPLACE ";" "," merge_paths "${csv_files}")
+execute_process(
+    COMMAND "${MERGE}" "--merge=${merge_paths}"
+    OUTPUT_FILE "${OUTPUT_DIR}/report.md"
+    RESULT_VARIABLE result
+)
+if(NOT result STREQUAL "0")
+  message(FATAL_ERROR "Merging the results failed (${result})")
+endif()
+file(READ "${OUTPUT_DIR}/report.md" report)
+message("${report}")
+message(STATUS "Report written to ${OUTPUT_DIR}/report.md")
@@ -0,0 +1,13 @@
+# Cross-compiles for AArch64 Linux with the GNU toolchain packaged by Debian and Ubuntu
+# (g++-aarch64-linux-gnu), e.g. for the benchmark matrix:
+#   -D rtz_benchmark_MATRIX_AARCH64_TOOLCHAIN=<source dir>/cmake/toolchains/aarch64-linux-gnu.cmake
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR aarch64)
+set(CMAKE_CXX_COMPILER aarch64-linux-gnu-g++)
+
+set(CMAKE_FIND_ROOT_PATH /usr/aarch64-linux-gnu)
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
@@ -0,0 +1,367 @@
+#ifndef RTZ_BENCHMARK_BATCH_HPP
+#define RTZ_BENCHMARK_BATCH_HPP
+
+#include <rtz_benchmark/remove_trailing_zeros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    #include <arm_neon.h>
+#endif
+
+#if defined(__AVX512F__) && defined(__GNUC__) && !defined(__clang__)
+    // GCC reports the vectors that avx512fintrin.h deliberately leaves undefined inside some
+    // intrinsics, e.g. _mm512_srli_epi64, as maybe uninitialized wherever they are inlined.
+    #define RTZ_BENCHMARK_BATCH_AVX512_BEGIN                                                      \
+        _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+    #define RTZ_BENCHMARK_BATCH_AVX512_END _Pragma("GCC diagnostic pop")
+#else
+    #define RTZ_BENCHMARK_BATCH_AVX512_BEGIN
+    #define RTZ_BENCHMARK_BATCH_AVX512_END
+#endif
+
+// Batched versions of the branchless kernels, processing a whole array of samples at once.
+// The vectorized code path is chosen at compile time according to the target instruction set,
+// and the remaining elements that do not fill a full vector are handled by the scalar kernel.
+namespace batch_detail {
+    // Copies lane values into a std::size_t array, widening or narrowing them if necessary.
+    template <class UInt, std::size_t count>
+    void store_numbers_of_removed_zeros(UInt const (&lanes)[count], std::size_t* first) noexcept {
+        std::copy_n(lanes, count, first);
+    }
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    inline __m256i cmplt_epu32(__m256i x, __m256i y) noexcept {
+        auto const sign = _mm256_set1_epi32(std::int32_t(UINT32_C(0x8000'0000)));
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+    }
+
+    inline __m256i cmplt_epu64(__m256i x, __m256i y) noexcept {
+        auto const sign = _mm256_set1_epi64x(std::int64_t(UINT64_C(0x8000'0000'0000'0000)));
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+    }
+
+    // AVX2 has no 64-bit x 64-bit -> 64-bit multiplication, so we compose it from three
+    // 32-bit x 32-bit -> 64-bit multiplications.
+    inline __m256i mullo_epu64(__m256i x, std::uint64_t y) noexcept {
+        auto const y_low = _mm256_set1_epi64x(std::int64_t(std::uint32_t(y)));
+        auto const y_high = _mm256_set1_epi64x(std::int64_t(y >> 32));
+        auto const cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), y_low),
+                                            _mm256_mul_epu32(x, y_high));
+        return _mm256_add_epi64(_mm256_mul_epu32(x, y_low), _mm256_slli_epi64(cross, 32));
+    }
+#endif
+
+#if defined(__AVX512F__)
+    inline __m512i mullo_epu64(__m512i x, std::uint64_t y) noexcept {
+    #if defined(__AVX512DQ__)
+        return _mm512_mullo_epi64(x, _mm512_set1_epi64(std::int64_t(y)));
+    #else
+        auto const y_low = _mm512_set1_epi64(std::int64_t(std::uint32_t(y)));
+        auto const y_high = _mm512_set1_epi64(std::int64_t(y >> 32));
+        auto const cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(x, 32), y_low),
+                                            _mm512_mul_epu32(x, y_high));
+        return _mm512_add_epi64(_mm512_mul_epu32(x, y_low), _mm512_slli_epi64(cross, 32));
+    #endif
+    }
+#endif
+
+#if defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    // NEON has no 64-bit x 64-bit -> 64-bit multiplication either.
+    inline uint64x2_t mullo_u64(uint64x2_t x, std::uint64_t y) noexcept {
+        auto const x_low = vmovn_u64(x);
+        auto const x_high = vshrn_n_u64(x, 32);
+        auto const y_low = vdup_n_u32(std::uint32_t(y));
+        auto const y_high = vdup_n_u32(std::uint32_t(y >> 32));
+        auto const cross = vmlal_u32(vmull_u32(x_high, y_low), x_low, y_high);
+        return vaddq_u64(vmull_u32(x_low, y_low), vshlq_n_u64(cross, 32));
+    }
+#endif
+}
+
+namespace alg32 {
+    namespace batch {
+#if defined(__AVX512F__)
+        constexpr char const* instruction_set = "AVX-512";
+#elif defined(__AVX2__)
+        constexpr char const* instruction_set = "AVX2";
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+        constexpr char const* instruction_set = "NEON";
+#else
+        constexpr char const* instruction_set = "scalar";
+#endif
+
+        // Both output spans must be at least as long as the input span. trimmed_numbers is
+        // allowed to be identical to the input.
+        inline void generalized_granlund_montgomery_branchless(
+            std::span<std::uint32_t const> input, std::span<std::uint32_t> trimmed_numbers,
+            std::span<std::size_t> numbers_of_removed_zeros) noexcept {
+            std::size_t i = 0;
+
+#if defined(__AVX512F__)
+            RTZ_BENCHMARK_BATCH_AVX512_BEGIN
+            for (; i + 16 <= input.size(); i += 16) {
+                auto const one = _mm512_set1_epi32(1);
+                auto n = _mm512_loadu_si512(input.data() + i);
+                auto s = _mm512_setzero_si512();
+
+                auto r = _mm512_mullo_epi32(n, _mm512_set1_epi32(std::int32_t(UINT32_C(184254097))));
+                auto b = _mm512_cmplt_epu32_mask(r, _mm512_set1_epi32(std::int32_t(UINT32_C(429509))));
+                s = _mm512_add_epi32(s, s);
+                s = _mm512_mask_add_epi32(s, b, s, one);
+                n = _mm512_mask_mov_epi32(n, b, _mm512_srli_epi32(r, 4));
+
+                r = _mm512_mullo_epi32(n, _mm512_set1_epi32(std::int32_t(UINT32_C(42949673))));
+                b = _mm512_cmplt_epu32_mask(r, _mm512_set1_epi32(std::int32_t(UINT32_C(42949673))));
+                s = _mm512_add_epi32(s, s);
+                s = _mm512_mask_add_epi32(s, b, s, one);
+                n = _mm512_mask_mov_epi32(n, b, _mm512_srli_epi32(r, 2));
+
+                r = _mm512_mullo_epi32(n, _mm512_set1_epi32(std::int32_t(UINT32_C(1288490189))));
+                b = _mm512_cmplt_epu32_mask(r, _mm512_set1_epi32(std::int32_t(UINT32_C(429496731))));
+                s = _mm512_add_epi32(s, s);
+                s = _mm512_mask_add_epi32(s, b, s, one);
+                n = _mm512_mask_mov_epi32(n, b, _mm512_srli_epi32(r, 1));
+
+                _mm512_storeu_si512(trimmed_numbers.data() + i, n);
+                if constexpr (std::is_same_v<std::size_t, std::uint64_t>) {
+                    _mm512_storeu_si512(numbers_of_removed_zeros.data() + i,
+                                        _mm512_cvtepu32_epi64(_mm512_castsi512_si256(s)));
+                    _mm512_storeu_si512(numbers_of_removed_zeros.data() + i + 8,
+                                        _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(s, 1)));
+                }
+                else {
+                    std::uint32_t lanes[16];
+                    _mm512_storeu_si512(lanes, s);
+                    batch_detail::store_numbers_of_removed_zeros(lanes,
+                                                                 numbers_of_removed_zeros.data() + i);
+                }
+            }
+            RTZ_BENCHMARK_BATCH_AVX512_END
+#elif defined(__AVX2__)
+            for (; i + 8 <= input.size(); i += 8) {
+                auto n = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input.data() + i));
+                auto s = _mm256_setzero_si256();
+
+                // Comparison results are either 0 or -1, so subtracting them adds the bit.
+                auto r = _mm256_mullo_epi32(n, _mm256_set1_epi32(std::int32_t(UINT32_C(184254097))));
+                auto b = batch_detail::cmplt_epu32(
+                    r, _mm256_set1_epi32(std::int32_t(UINT32_C(429509))));
+                s = _mm256_sub_epi32(_mm256_add_epi32(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi32(r, 4), b);
+
+                r = _mm256_mullo_epi32(n, _mm256_set1_epi32(std::int32_t(UINT32_C(42949673))));
+                b = batch_detail::cmplt_epu32(r, _mm256_set1_epi32(std::int32_t(UINT32_C(42949673))));
+                s = _mm256_sub_epi32(_mm256_add_epi32(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi32(r, 2), b);
+
+                r = _mm256_mullo_epi32(n, _mm256_set1_epi32(std::int32_t(UINT32_C(1288490189))));
+                b = batch_detail::cmplt_epu32(
+                    r, _mm256_set1_epi32(std::int32_t(UINT32_C(429496731))));
+                s = _mm256_sub_epi32(_mm256_add_epi32(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi32(r, 1), b);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(trimmed_numbers.data() + i), n);
+                if constexpr (std::is_same_v<std::size_t, std::uint64_t>) {
+                    _mm256_storeu_si256(
+                        reinterpret_cast<__m256i*>(numbers_of_removed_zeros.data() + i),
+                        _mm256_cvtepu32_epi64(_mm256_castsi256_si128(s)));
+                    _mm256_storeu_si256(
+                        reinterpret_cast<__m256i*>(numbers_of_removed_zeros.data() + i + 4),
+                        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(s, 1)));
+                }
+                else {
+                    std::uint32_t lanes[8];
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), s);
+                    batch_detail::store_numbers_of_removed_zeros(lanes,
+                                                                 numbers_of_removed_zeros.data() + i);
+                }
+            }
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+            for (; i + 4 <= input.size(); i += 4) {
+                auto n = vld1q_u32(input.data() + i);
+                auto s = vdupq_n_u32(0);
+
+                // Comparison results are either 0 or all ones, so subtracting them adds the bit.
+                auto r = vmulq_n_u32(n, UINT32_C(184254097));
+                auto b = vcltq_u32(r, vdupq_n_u32(UINT32_C(429509)));
+                s = vsubq_u32(vaddq_u32(s, s), b);
+                n = vbslq_u32(b, vshrq_n_u32(r, 4), n);
+
+                r = vmulq_n_u32(n, UINT32_C(42949673));
+                b = vcltq_u32(r, vdupq_n_u32(UINT32_C(42949673)));
+                s = vsubq_u32(vaddq_u32(s, s), b);
+                n = vbslq_u32(b, vshrq_n_u32(r, 2), n);
+
+                r = vmulq_n_u32(n, UINT32_C(1288490189));
+                b = vcltq_u32(r, vdupq_n_u32(UINT32_C(429496731)));
+                s = vsubq_u32(vaddq_u32(s, s), b);
+                n = vbslq_u32(b, vshrq_n_u32(r, 1), n);
+
+                vst1q_u32(trimmed_numbers.data() + i, n);
+                std::uint32_t lanes[4];
+                vst1q_u32(lanes, s);
+                batch_detail::store_numbers_of_removed_zeros(
+                    lanes, numbers_of_removed_zeros.data() + i);
+            }
+#endif
+
+            for (; i < input.size(); ++i) {
+                auto const result = alg32::generalized_granlund_montgomery_branchless(input[i]);
+                trimmed_numbers[i] = result.trimmed_number;
+                numbers_of_removed_zeros[i] = result.number_of_removed_zeros;
+            }
+        }
+    }
+}
+
+namespace alg64 {
+    namespace batch {
+        using alg32::batch::instruction_set;
+
+        // Both output spans must be at least as long as the input span. trimmed_numbers is
+        // allowed to be identical to the input.
+        inline void generalized_granlund_montgomery_branchless(
+            std::span<std::uint64_t const> input, std::span<std::uint64_t> trimmed_numbers,
+            std::span<std::size_t> numbers_of_removed_zeros) noexcept {
+            std::size_t i = 0;
+
+#if defined(__AVX512F__)
+            RTZ_BENCHMARK_BATCH_AVX512_BEGIN
+            for (; i + 8 <= input.size(); i += 8) {
+                auto const one = _mm512_set1_epi64(1);
+                auto n = _mm512_loadu_si512(input.data() + i);
+                auto s = _mm512_setzero_si512();
+
+                auto r = batch_detail::mullo_epu64(n, UINT64_C(28999941890838049));
+                auto b = _mm512_cmplt_epu64_mask(
+                    r, _mm512_set1_epi64(std::int64_t(UINT64_C(184467440969))));
+                s = _mm512_add_epi64(s, s);
+                s = _mm512_mask_add_epi64(s, b, s, one);
+                n = _mm512_mask_mov_epi64(n, b, _mm512_srli_epi64(r, 8));
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(182622766329724561));
+                b = _mm512_cmplt_epu64_mask(
+                    r, _mm512_set1_epi64(std::int64_t(UINT64_C(1844674407370971))));
+                s = _mm512_add_epi64(s, s);
+                s = _mm512_mask_add_epi64(s, b, s, one);
+                n = _mm512_mask_mov_epi64(n, b, _mm512_srli_epi64(r, 4));
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(14941862699704736809));
+                b = _mm512_cmplt_epu64_mask(
+                    r, _mm512_set1_epi64(std::int64_t(UINT64_C(184467440737095517))));
+                s = _mm512_add_epi64(s, s);
+                s = _mm512_mask_add_epi64(s, b, s, one);
+                n = _mm512_mask_mov_epi64(n, b, _mm512_srli_epi64(r, 2));
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(5534023222112865485));
+                b = _mm512_cmplt_epu64_mask(
+                    r, _mm512_set1_epi64(std::int64_t(UINT64_C(1844674407370955163))));
+                s = _mm512_add_epi64(s, s);
+                s = _mm512_mask_add_epi64(s, b, s, one);
+                n = _mm512_mask_mov_epi64(n, b, _mm512_srli_epi64(r, 1));
+
+                _mm512_storeu_si512(trimmed_numbers.data() + i, n);
+                if constexpr (std::is_same_v<std::size_t, std::uint64_t>) {
+                    _mm512_storeu_si512(numbers_of_removed_zeros.data() + i, s);
+                }
+                else {
+                    std::uint64_t lanes[8];
+                    _mm512_storeu_si512(lanes, s);
+                    batch_detail::store_numbers_of_removed_zeros(lanes,
+                                                                 numbers_of_removed_zeros.data() + i);
+                }
+            }
+            RTZ_BENCHMARK_BATCH_AVX512_END
+#elif defined(__AVX2__)
+            for (; i + 4 <= input.size(); i += 4) {
+                auto n = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input.data() + i));
+                auto s = _mm256_setzero_si256();
+
+                // Comparison results are either 0 or -1, so subtracting them adds the bit.
+                auto r = batch_detail::mullo_epu64(n, UINT64_C(28999941890838049));
+                auto b = batch_detail::cmplt_epu64(
+                    r, _mm256_set1_epi64x(std::int64_t(UINT64_C(184467440969))));
+                s = _mm256_sub_epi64(_mm256_add_epi64(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi64(r, 8), b);
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(182622766329724561));
+                b = batch_detail::cmplt_epu64(
+                    r, _mm256_set1_epi64x(std::int64_t(UINT64_C(1844674407370971))));
+                s = _mm256_sub_epi64(_mm256_add_epi64(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi64(r, 4), b);
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(14941862699704736809));
+                b = batch_detail::cmplt_epu64(
+                    r, _mm256_set1_epi64x(std::int64_t(UINT64_C(184467440737095517))));
+                s = _mm256_sub_epi64(_mm256_add_epi64(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi64(r, 2), b);
+
+                r = batch_detail::mullo_epu64(n, UINT64_C(5534023222112865485));
+                b = batch_detail::cmplt_epu64(
+                    r, _mm256_set1_epi64x(std::int64_t(UINT64_C(1844674407370955163))));
+                s = _mm256_sub_epi64(_mm256_add_epi64(s, s), b);
+                n = _mm256_blendv_epi8(n, _mm256_srli_epi64(r, 1), b);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(trimmed_numbers.data() + i), n);
+                if constexpr (std::is_same_v<std::size_t, std::uint64_t>) {
+                    _mm256_storeu_si256(
+                        reinterpret_cast<__m256i*>(numbers_of_removed_zeros.data() + i), s);
+                }
+                else {
+                    std::uint64_t lanes[4];
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), s);
+                    batch_detail::store_numbers_of_removed_zeros(lanes,
+                                                                 numbers_of_removed_zeros.data() + i);
+                }
+            }
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+            for (; i + 2 <= input.size(); i += 2) {
+                auto n = vld1q_u64(input.data() + i);
+                auto s = vdupq_n_u64(0);
+
+                // Comparison results are either 0 or all ones, so subtracting them adds the bit.
+                auto r = batch_detail::mullo_u64(n, UINT64_C(28999941890838049));
+                auto b = vcltq_u64(r, vdupq_n_u64(UINT64_C(184467440969)));
+                s = vsubq_u64(vaddq_u64(s, s), b);
+                n = vbslq_u64(b, vshrq_n_u64(r, 8), n);
+
+                r = batch_detail::mullo_u64(n, UINT64_C(182622766329724561));
+                b = vcltq_u64(r, vdupq_n_u64(UINT64_C(1844674407370971)));
+                s = vsubq_u64(vaddq_u64(s, s), b);
+                n = vbslq_u64(b, vshrq_n_u64(r, 4), n);
+
+                r = batch_detail::mullo_u64(n, UINT64_C(14941862699704736809));
+                b = vcltq_u64(r, vdupq_n_u64(UINT64_C(184467440737095517)));
+                s = vsubq_u64(vaddq_u64(s, s), b);
+                n = vbslq_u64(b, vshrq_n_u64(r, 2), n);
+
+                r = batch_detail::mullo_u64(n, UINT64_C(5534023222112865485));
+                b = vcltq_u64(r, vdupq_n_u64(UINT64_C(1844674407370955163)));
+                s = vsubq_u64(vaddq_u64(s, s), b);
+                n = vbslq_u64(b, vshrq_n_u64(r, 1), n);
+
+                vst1q_u64(trimmed_numbers.data() + i, n);
+                std::uint64_t lanes[2];
+                vst1q_u64(lanes, s);
+                batch_detail::store_numbers_of_removed_zeros(
+                    lanes, numbers_of_removed_zeros.data() + i);
+            }
+#endif
+
+            for (; i < input.size(); ++i) {
+                auto const result = alg64::generalized_granlund_montgomery_branchless(input[i]);
+                trimmed_numbers[i] = result.trimmed_number;
+                numbers_of_removed_zeros[i] = result.number_of_removed_zeros;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef RTZ_BENCHMARK_BULK_HPP
+#define RTZ_BENCHMARK_BULK_HPP
+
+#include <rtz_benchmark/batch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    // _mm_stream_si128 and _mm_sfence.
+    #define RTZ_BENCHMARK_BULK_NON_TEMPORAL_STORES
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+// In-place trimming of arrays much larger than the last-level cache, where the batch kernels wait
+// on memory rather than the other way around. The array is processed in tiles small enough to
+// stay in the L1 cache between being read and written back, and the batch kernel runs on each
+// tile in blocks, each one prefetching the block a fixed distance ahead. The numbers of removed
+// zeros can be written with non-temporal stores, and contiguous ranges of tiles are given to
+// separate threads.
+namespace bulk {
+    struct options {
+        // Numbers per tile. The tile and the std::size_t numbers of removed zeros the batch kernel
+        // writes for it must fit in the L1 cache together.
+        std::size_t tile_size = 1024;
+        // How many bytes ahead of the current block of the array to prefetch; 0 leaves it to the
+        // hardware prefetchers.
+        std::size_t prefetch_distance = 2048;
+        // Write the numbers of removed zeros with non-temporal stores, which go around the caches,
+        // so that their lines are not read from memory before being overwritten nor evict the
+        // array. The trimmed numbers are always written back with ordinary stores: their lines are
+        // in the cache already, having just been read, and streaming them out instead measured
+        // about twice as slow. Ignored if non_temporal_stores_available is false.
+        bool non_temporal_stores = false;
+        // 0 for std::thread::hardware_concurrency(). The threads are started by every call, which
+        // is negligible next to a pass over an array of this size.
+        std::size_t number_of_threads = 1;
+    };
+
+#if defined(RTZ_BENCHMARK_BULK_NON_TEMPORAL_STORES)
+    inline constexpr bool non_temporal_stores_available = true;
+#else
+    inline constexpr bool non_temporal_stores_available = false;
+#endif
+
+    namespace detail {
+        inline constexpr std::size_t cache_line_size = 64;
+        // Bytes of the array processed between two rounds of prefetches.
+        inline constexpr std::size_t block_size_in_bytes = 8 * cache_line_size;
+
+        inline void prefetch_for_write(void const* address) noexcept {
+#if defined(__GNUC__)
+            __builtin_prefetch(address, 1);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_prefetch(static_cast<char const*>(address), _MM_HINT_T0);
+#else
+            static_cast<void>(address);
+#endif
+        }
+
+        // Copies size bytes, with non-temporal stores from the first 16-byte aligned byte of
+        // destination on if they are available.
+        inline void stream_copy(void* destination, void const* source, std::size_t size) noexcept {
+            auto* out = static_cast<unsigned char*>(destination);
+            auto const* in = static_cast<unsigned char const*>(source);
+#if defined(RTZ_BENCHMARK_BULK_NON_TEMPORAL_STORES)
+            auto const head =
+                std::min(size, (16 - reinterpret_cast<std::uintptr_t>(out) % 16) % 16);
+            std::memcpy(out, in, head);
+            out += head;
+            in += head;
+            size -= head;
+            for (; size >= 16; size -= 16, out += 16, in += 16) {
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out),
+                                 _mm_loadu_si128(reinterpret_cast<__m128i const*>(in)));
+            }
+#endif
+            std::memcpy(out, in, size);
+        }
+
+        // Non-temporal stores are weakly ordered, so they must be fenced before another thread
+        // may read their results.
+        inline void store_fence() noexcept {
+#if defined(RTZ_BENCHMARK_BULK_NON_TEMPORAL_STORES)
+            _mm_sfence();
+#endif
+        }
+
+        template <auto batch_kernel, class UInt>
+        void process_range(std::span<UInt> numbers, std::span<std::uint8_t> numbers_of_removed_zeros,
+                           options const& opts) {
+            auto const non_temporal = non_temporal_stores_available && opts.non_temporal_stores;
+            auto const block_size = block_size_in_bytes / sizeof(UInt);
+            auto const prefetch_distance = opts.prefetch_distance / sizeof(UInt);
+            auto const numbers_per_line = cache_line_size / sizeof(UInt);
+
+            std::vector<std::size_t> tile_numbers_of_removed_zeros(opts.tile_size);
+            // Only used with non-temporal stores, to be streamed to numbers_of_removed_zeros.
+            std::vector<std::uint8_t> narrowed_tile(non_temporal ? opts.tile_size : 0);
+
+            for (std::size_t first = 0; first < numbers.size(); first += opts.tile_size) {
+                auto const size = std::min(opts.tile_size, numbers.size() - first);
+                auto const tile = numbers.subspan(first, size);
+                for (std::size_t idx = 0; idx < size; idx += block_size) {
+                    if (prefetch_distance != 0) {
+                        auto const ahead = first + idx + prefetch_distance;
+                        auto const last = std::min(ahead + block_size, numbers.size());
+                        for (auto line = ahead; line < last; line += numbers_per_line) {
+                            prefetch_for_write(numbers.data() + line);
+                        }
+                    }
+                    auto const count = std::min(block_size, size - idx);
+                    batch_kernel(tile.subspan(idx, count), tile.subspan(idx, count),
+                                 std::span<std::size_t>{tile_numbers_of_removed_zeros}.subspan(
+                                     idx, count));
+                }
+
+                if (non_temporal) {
+                    std::copy_n(tile_numbers_of_removed_zeros.begin(), size, narrowed_tile.begin());
+                    stream_copy(numbers_of_removed_zeros.data() + first, narrowed_tile.data(),
+                                size);
+                }
+                else {
+                    std::copy_n(tile_numbers_of_removed_zeros.begin(), size,
+                                numbers_of_removed_zeros.begin() + first);
+                }
+            }
+            if (non_temporal) {
+                store_fence();
+            }
+        }
+
+        // Splits the array into one range of whole tiles per thread, the calling thread taking
+        // the first one.
+        template <auto batch_kernel, class UInt>
+        void remove_trailing_zeros(std::span<UInt> numbers,
+                                   std::span<std::uint8_t> numbers_of_removed_zeros,
+                                   options opts) {
+            opts.tile_size = std::max(opts.tile_size, std::size_t(1));
+            auto const number_of_tiles = (numbers.size() + opts.tile_size - 1) / opts.tile_size;
+            auto number_of_threads =
+                opts.number_of_threads != 0
+                    ? opts.number_of_threads
+                    : std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1));
+            number_of_threads = std::max(std::min(number_of_threads, number_of_tiles),
+                                         std::size_t(1));
+            auto const range_size =
+                (number_of_tiles + number_of_threads - 1) / number_of_threads * opts.tile_size;
+
+            std::vector<std::thread> threads;
+            for (auto first = range_size; first < numbers.size(); first += range_size) {
+                auto const size = std::min(range_size, numbers.size() - first);
+                threads.emplace_back([=, &opts] {
+                    process_range<batch_kernel>(numbers.subspan(first, size),
+                                                numbers_of_removed_zeros.subspan(first, size),
+                                                opts);
+                });
+            }
+            auto const size = std::min(range_size, numbers.size());
+            process_range<batch_kernel>(numbers.first(size), numbers_of_removed_zeros.first(size),
+                                        opts);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    }
+
+    // Replaces every number by its trimmed number, computed by the batch kernel
+    // alg32::batch::generalized_granlund_montgomery_branchless, and stores its number of removed
+    // zeros into numbers_of_removed_zeros, which must be at least as long as numbers. The numbers
+    // must be nonzero with at most 8 digits.
+    inline void remove_trailing_zeros32(std::span<std::uint32_t> numbers,
+                                        std::span<std::uint8_t> numbers_of_removed_zeros,
+                                        options const& opts = {}) {
+        detail::remove_trailing_zeros<alg32::batch::generalized_granlund_montgomery_branchless>(
+            numbers, numbers_of_removed_zeros, opts);
+    }
+
+    // Same as remove_trailing_zeros32 with alg64::batch::generalized_granlund_montgomery_branchless,
+    // for nonzero numbers with at most 16 digits.
+    inline void remove_trailing_zeros64(std::span<std::uint64_t> numbers,
+                                        std::span<std::uint8_t> numbers_of_removed_zeros,
+                                        options const& opts = {}) {
+        detail::remove_trailing_zeros<alg64::batch::generalized_granlund_montgomery_branchless>(
+            numbers, numbers_of_removed_zeros, opts);
+    }
+}
+
+#endif
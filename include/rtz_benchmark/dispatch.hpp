@@ -0,0 +1,180 @@
+#ifndef RTZ_BENCHMARK_DISPATCH_HPP
+#define RTZ_BENCHMARK_DISPATCH_HPP
+
+#include <rtz_benchmark/remove_trailing_zeros.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <cpuid.h>
+    // Kernels compiled for BMI1 (tzcnt) and BMI2 (mulx) in addition to the target, regardless of
+    // the compiler flags; used only after CPUID reports both.
+    #define RTZ_BENCHMARK_DISPATCH_BMI_CLONES
+    #define RTZ_BENCHMARK_DISPATCH_TARGET_BMI __attribute__((target("bmi,bmi2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+// Runtime selection of the 64-bit kernel. dispatch::remove_trailing_zeros64 calls the kernel of
+// the selected variant through a cached function pointer, which is resolved from CPUID on the
+// first call unless another variant is selected before, e.g. after timing them all on typical
+// inputs.
+namespace dispatch {
+    struct cpu_features {
+        // tzcnt
+        bool bmi1 = false;
+        // mulx
+        bool bmi2 = false;
+    };
+
+    inline cpu_features detect_cpu_features() noexcept {
+        cpu_features features;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0) {
+            features.bmi1 = (ebx & (1u << 3)) != 0;
+            features.bmi2 = (ebx & (1u << 8)) != 0;
+        }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuidex(info, 7, 0);
+            features.bmi1 = (info[1] & (1 << 3)) != 0;
+            features.bmi2 = (info[1] & (1 << 8)) != 0;
+        }
+#endif
+        return features;
+    }
+
+    using kernel64 = remove_trailing_zeros_return<std::uint64_t> (*)(std::uint64_t) noexcept;
+
+    struct variant64 {
+        char const* name;
+        kernel64 kernel;
+        bool requires_bmi;
+    };
+
+    constexpr bool is_supported(variant64 const& variant, cpu_features const& features) noexcept {
+        return !variant.requires_bmi || (features.bmi1 && features.bmi2);
+    }
+
+    namespace detail {
+#if defined(RTZ_BENCHMARK_DISPATCH_BMI_CLONES)
+        // The kernels are inlined into these, so the rotations of Granlund-Montgomery's test
+        // become rorx, the 128-bit products of Lemire's test become mulx and countr_zero becomes
+        // tzcnt.
+        RTZ_BENCHMARK_DISPATCH_TARGET_BMI inline remove_trailing_zeros_return<std::uint64_t>
+        granlund_montgomery_branchless_bmi(std::uint64_t n) noexcept {
+            return alg64::granlund_montgomery_branchless(n);
+        }
+
+        RTZ_BENCHMARK_DISPATCH_TARGET_BMI inline remove_trailing_zeros_return<std::uint64_t>
+        lemire_branchless_bmi(std::uint64_t n) noexcept {
+            return alg64::lemire_branchless(n);
+        }
+
+        RTZ_BENCHMARK_DISPATCH_TARGET_BMI inline remove_trailing_zeros_return<std::uint64_t>
+        lemire_8_2_1_bmi(std::uint64_t n) noexcept {
+            return alg64::lemire_8_2_1(n);
+        }
+
+        RTZ_BENCHMARK_DISPATCH_TARGET_BMI inline remove_trailing_zeros_return<std::uint64_t>
+        ctz_inverse_table_bmi(std::uint64_t n) noexcept {
+            return alg64::ctz_inverse_table(n);
+        }
+#endif
+    }
+
+    // All variants work for numbers with at most 16 digits. Without calibration, the first one the
+    // CPU supports is used, so CPUID only chooses between the first two: the BMI2 clone and the
+    // portable Granlund-Montgomery branchless kernel, which are about as fast in README.md. The
+    // order of the others does not matter; use_variant64, which --calibrate-dispatch calls with the
+    // fastest one measured, is how they get selected.
+    inline constexpr variant64 variants64[] = {
+#if defined(RTZ_BENCHMARK_DISPATCH_BMI_CLONES)
+        {"Granlund-Montgomery branchless (BMI2)", detail::granlund_montgomery_branchless_bmi,
+         true},
+#endif
+        {"Granlund-Montgomery branchless", alg64::granlund_montgomery_branchless, false},
+        {"Generalized Granlund-Montgomery branchless",
+         alg64::generalized_granlund_montgomery_branchless, false},
+#if defined(RTZ_BENCHMARK_DISPATCH_BMI_CLONES)
+        {"Lemire branchless (BMI2)", detail::lemire_branchless_bmi, true},
+#endif
+        {"Lemire branchless", alg64::lemire_branchless, false},
+        {"Granlund-Montgomery 8-2-1", alg64::granlund_montgomery_8_2_1, false},
+#if defined(RTZ_BENCHMARK_DISPATCH_BMI_CLONES)
+        {"Lemire 8-2-1 (BMI2)", detail::lemire_8_2_1_bmi, true},
+#endif
+        {"Lemire 8-2-1", alg64::lemire_8_2_1, false},
+#if defined(RTZ_BENCHMARK_DISPATCH_BMI_CLONES)
+        {"Count trailing zeros + inverse table (BMI)", detail::ctz_inverse_table_bmi, true},
+#endif
+        {"Count trailing zeros + inverse table", alg64::ctz_inverse_table, false},
+    };
+
+    // The first variant supported by the CPU.
+    inline std::size_t select_variant64(cpu_features const& features) noexcept {
+        for (std::size_t idx = 0; idx < std::size(variants64); ++idx) {
+            if (is_supported(variants64[idx], features)) {
+                return idx;
+            }
+        }
+        return 0;
+    }
+
+    namespace detail {
+        inline remove_trailing_zeros_return<std::uint64_t>
+        resolve_and_call64(std::uint64_t n) noexcept;
+
+        // Selected until the first call resolves the choice from CPUID.
+        inline constexpr variant64 unresolved_variant64 = {"unresolved", resolve_and_call64, false};
+
+        // The kernel called by remove_trailing_zeros64, so that a call is a single load and an
+        // indirect call, and the variant it belongs to, which is only read for its name. Threads
+        // racing on the first call store the same choice.
+        inline std::atomic<kernel64> selected_kernel64{resolve_and_call64};
+        inline std::atomic<variant64 const*> selected_variant_pointer64{&unresolved_variant64};
+
+        inline void store_selected_variant64(variant64 const& variant) noexcept {
+            selected_variant_pointer64.store(&variant, std::memory_order_relaxed);
+            selected_kernel64.store(variant.kernel, std::memory_order_relaxed);
+        }
+
+        inline variant64 const& resolve_variant64() noexcept {
+            auto const& variant = variants64[select_variant64(detect_cpu_features())];
+            store_selected_variant64(variant);
+            return variant;
+        }
+
+        inline remove_trailing_zeros_return<std::uint64_t>
+        resolve_and_call64(std::uint64_t n) noexcept {
+            return resolve_variant64().kernel(n);
+        }
+    }
+
+    // idx must be less than std::size(variants64) and the variant supported by the CPU.
+    inline void use_variant64(std::size_t idx) noexcept {
+        detail::store_selected_variant64(variants64[idx]);
+    }
+
+    // Resolves the choice from CPUID if it has not been made yet.
+    inline variant64 const& selected_variant64() noexcept {
+        auto const* variant = detail::selected_variant_pointer64.load(std::memory_order_relaxed);
+        if (variant == &detail::unresolved_variant64) {
+            return detail::resolve_variant64();
+        }
+        return *variant;
+    }
+
+    inline remove_trailing_zeros_return<std::uint64_t>
+    remove_trailing_zeros64(std::uint64_t n) noexcept {
+        return detail::selected_kernel64.load(std::memory_order_relaxed)(n);
+    }
+}
+
+#endif
@@ -0,0 +1,357 @@
+#ifndef RTZ_BENCHMARK_GENERATED_HPP
+#define RTZ_BENCHMARK_GENERATED_HPP
+
+#include <rtz_benchmark/remove_trailing_zeros.hpp>
+#include <rtz_benchmark/wuint.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Kernels for arbitrary chunk schedules, with the magic constants of each divisibility test
+// computed at compile time from the divisor 10^k and the largest input max_n, instead of being
+// hard-coded. Only std::uint32_t and std::uint64_t are supported.
+namespace generated {
+    enum class divisibility_test { granlund_montgomery, generalized_granlund_montgomery, lemire };
+
+    // Numbers of trailing zeros removed at once, in decreasing order and ending with 1. For
+    // example, {{8, 2, 1}, 3} removes 10^8 at most once, then 10^2 as long as possible, then 10
+    // at most once, like the hand-written 8-2-1 kernels.
+    struct chunk_schedule {
+        static constexpr std::size_t max_size = 8;
+        std::size_t exponents[max_size] = {};
+        std::size_t size = 0;
+    };
+
+    namespace detail {
+        template <class UInt>
+        constexpr UInt wrapping_power(UInt a, std::size_t k) noexcept {
+            UInt result = 1;
+            for (std::size_t i = 0; i < k; ++i) {
+                result = UInt(result * a);
+            }
+            return result;
+        }
+
+        // Inverse of an odd number modulo 2^(bit width); each Newton step doubles the number of
+        // correct bits, starting from 3.
+        template <class UInt>
+        constexpr UInt modular_inverse(UInt a) noexcept {
+            auto x = a;
+            for (int i = 0; i < 6; ++i) {
+                x = UInt(x * UInt(2 - a * x));
+            }
+            return x;
+        }
+
+        template <class UInt>
+        constexpr std::size_t number_of_digits(UInt n) noexcept {
+            std::size_t digits = 1;
+            for (; n >= 10; n /= 10) {
+                ++digits;
+            }
+            return digits;
+        }
+
+        // Chunks are applied at most this many times, or as long as possible if it is more than 1.
+        // Zero means the chunk is larger than the number of trailing zeros that can remain.
+        template <class UInt>
+        constexpr std::size_t compute_repetitions(chunk_schedule const& schedule, UInt max_n,
+                                                  std::size_t idx) noexcept {
+            auto remaining = number_of_digits(max_n) - 1;
+            for (std::size_t i = 0; i < idx; ++i) {
+                remaining = std::min(remaining, schedule.exponents[i] - 1);
+            }
+            return remaining / schedule.exponents[idx];
+        }
+    }
+
+    template <class UInt>
+    struct granlund_montgomery_constants {
+        UInt multiplier;
+        UInt threshold;
+    };
+
+    // n is divisible by 10^k iff rotr(n * multiplier, k) < threshold, for every n. The multiplier
+    // is the inverse of 5^k and the threshold is floor((2^b - 1) / 10^k) + 1.
+    template <class UInt>
+    constexpr granlund_montgomery_constants<UInt>
+    compute_granlund_montgomery_constants(std::size_t exponent) noexcept {
+        return {detail::modular_inverse(detail::wrapping_power(UInt(5), exponent)),
+                UInt(std::numeric_limits<UInt>::max() / detail::wrapping_power(UInt(10), exponent) +
+                     1)};
+    }
+
+    // n is divisible by 10^k iff n * multiplier mod 2^b < threshold, for every n < 2^(b - k).
+    // The multiplier is the inverse of 5^k + 2^(b - k), which is also an inverse of 5^k modulo
+    // 2^(b - k), so multiples 10^k * q are mapped to 2^k * q. The inputs mapped below the
+    // threshold floor((2^(b - k) - 1) / 5^k) + 1 are then exactly:
+    //   - the multiples of 10^k, and
+    //   - numbers of the form 5^k * v + c * 2^(b - k) with 0 < c < 2^k, which are at least
+    //     2^(b - k) and thus out of range.
+    template <class UInt>
+    constexpr granlund_montgomery_constants<UInt>
+    compute_generalized_granlund_montgomery_constants(std::size_t exponent) noexcept {
+        constexpr auto bits = std::size_t(std::numeric_limits<UInt>::digits);
+        auto const power_of_5 = detail::wrapping_power(UInt(5), exponent);
+        return {detail::modular_inverse(UInt(power_of_5 + (UInt(1) << (bits - exponent)))),
+                UInt(((UInt(1) << (bits - exponent)) - 1) / power_of_5 + 1)};
+    }
+
+    template <class UInt>
+    constexpr bool is_generalized_granlund_montgomery_applicable(std::size_t exponent,
+                                                                 UInt max_n) noexcept {
+        constexpr auto bits = std::size_t(std::numeric_limits<UInt>::digits);
+        return exponent < bits && max_n < (UInt(1) << (bits - exponent));
+    }
+
+    template <class UInt>
+    struct lemire_constants {
+        // Set only if constants working for all inputs up to max_n were found.
+        bool found = false;
+        UInt multiplier = 0;
+        std::size_t shift = 0;
+    };
+
+    // With d = 10^k, multiplier = ceil(2^shift / d) and error = multiplier * d - 2^shift, for
+    // n = q * d + r the low shift bits of n * multiplier are q * error + r * multiplier as long
+    // as that does not wrap around. So n is divisible by d iff they are below the multiplier,
+    // and then n * multiplier >> shift is q, provided (q + 1) * error < multiplier. The smallest
+    // shift of at least b bits satisfying this for q = floor(max_n / d) is chosen, with the
+    // multiplier fitting in b bits.
+    template <class UInt>
+    constexpr lemire_constants<UInt> compute_lemire_constants(std::size_t exponent,
+                                                              UInt max_n) noexcept {
+        constexpr auto bits = std::size_t(std::numeric_limits<UInt>::digits);
+        auto const divisor = detail::wrapping_power(UInt(10), exponent);
+        auto const max_quotient = UInt(max_n / divisor);
+
+        for (auto shift = bits; shift < 2 * bits; ++shift) {
+            // Long division of 2^shift by divisor, one bit at a time; the remainder is kept
+            // below divisor without overflowing.
+            UInt quotient = 0;
+            UInt remainder = 1;
+            bool overflow = false;
+            for (std::size_t i = 0; i < shift; ++i) {
+                overflow = overflow || (quotient >> (bits - 1)) != 0;
+                quotient = UInt(quotient << 1);
+                if (remainder >= divisor - remainder) {
+                    remainder -= divisor - remainder;
+                    quotient |= 1;
+                }
+                else {
+                    remainder = UInt(remainder * 2);
+                }
+            }
+            if (overflow || quotient == std::numeric_limits<UInt>::max()) {
+                break;
+            }
+            auto const multiplier = UInt(quotient + 1);
+            // 2^shift is a multiple of 2^b, so the error is just the low b bits.
+            auto const error = UInt(multiplier * divisor);
+            if (max_quotient < (multiplier - 1) / error) {
+                return {true, multiplier, shift};
+            }
+        }
+        return {};
+    }
+
+    template <class UInt, divisibility_test test, UInt max_n, std::size_t exponent>
+    constexpr bool is_divisor_applicable() noexcept {
+        if (exponent == 0 || exponent > std::size_t(std::numeric_limits<UInt>::digits10)) {
+            return false;
+        }
+        if constexpr (test == divisibility_test::generalized_granlund_montgomery) {
+            return is_generalized_granlund_montgomery_applicable(exponent, max_n);
+        }
+        else if constexpr (test == divisibility_test::lemire) {
+            return compute_lemire_constants(exponent, max_n).found;
+        }
+        else {
+            return true;
+        }
+    }
+
+    template <class UInt>
+    struct division_result {
+        UInt quotient;
+        bool divisible;
+    };
+
+    // Tests whether n <= max_n is divisible by 10^exponent, and computes the quotient if it is.
+    template <class UInt, divisibility_test test, UInt max_n, std::size_t exponent>
+    constexpr division_result<UInt> try_divide(UInt n) noexcept {
+        static_assert(std::is_same_v<UInt, std::uint32_t> || std::is_same_v<UInt, std::uint64_t>);
+        static_assert(is_divisor_applicable<UInt, test, max_n, exponent>());
+        constexpr auto bits = std::size_t(std::numeric_limits<UInt>::digits);
+
+        if constexpr (test == divisibility_test::granlund_montgomery) {
+            constexpr auto constants = compute_granlund_montgomery_constants<UInt>(exponent);
+            auto const r = rotr<bits>(UInt(n * constants.multiplier), exponent);
+            return {r, r < constants.threshold};
+        }
+        else if constexpr (test == divisibility_test::generalized_granlund_montgomery) {
+            constexpr auto constants =
+                compute_generalized_granlund_montgomery_constants<UInt>(exponent);
+            auto const r = UInt(n * constants.multiplier);
+            return {UInt(r >> exponent), r < constants.threshold};
+        }
+        else {
+            constexpr auto constants = compute_lemire_constants(exponent, max_n);
+            if constexpr (bits == 32) {
+                auto const r = n * std::uint64_t(constants.multiplier);
+                return {std::uint32_t(r >> constants.shift),
+                        (r & ((std::uint64_t(1) << constants.shift) - 1)) < constants.multiplier};
+            }
+            else if constexpr (constants.shift == 64) {
+                auto const r = wuint::umul128(n, constants.multiplier);
+                return {r.high(), r.low() < constants.multiplier};
+            }
+            else {
+                auto const r = wuint::umul128(n, constants.multiplier);
+                return {r.high() >> (constants.shift - 64),
+                        (r.high() & ((std::uint64_t(1) << (constants.shift - 64)) - 1)) == 0 &&
+                            r.low() < constants.multiplier};
+            }
+        }
+    }
+
+    // Whether the schedule removes all trailing zeros of every input up to max_n, and the
+    // divisibility test works for each chunk. A branchless schedule must not need any chunk
+    // more than once.
+    template <class UInt, divisibility_test test, UInt max_n, chunk_schedule schedule>
+    constexpr bool is_valid_schedule(bool branchless) noexcept {
+        if (schedule.size == 0 || schedule.size > chunk_schedule::max_size ||
+            schedule.exponents[schedule.size - 1] != 1) {
+            return false;
+        }
+        for (std::size_t idx = 0; idx < schedule.size; ++idx) {
+            auto const repetitions = detail::compute_repetitions(schedule, max_n, idx);
+            if ((idx != 0 && schedule.exponents[idx] >= schedule.exponents[idx - 1]) ||
+                repetitions == 0 || (branchless && repetitions > 1)) {
+                return false;
+            }
+        }
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            return (is_divisor_applicable<UInt, test, max_n, schedule.exponents[I]>() && ...);
+        }(std::make_index_sequence<schedule.size>{});
+    }
+
+    template <class UInt, divisibility_test test, UInt max_n, chunk_schedule schedule>
+    constexpr remove_trailing_zeros_return<UInt> remove_trailing_zeros(UInt n) noexcept {
+        static_assert(is_valid_schedule<UInt, test, max_n, schedule>(false));
+        std::size_t s = 0;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (
+                [&] {
+                    constexpr auto exponent = schedule.exponents[I];
+                    if constexpr (detail::compute_repetitions(schedule, max_n, I) == 1) {
+                        auto const r = try_divide<UInt, test, max_n, exponent>(n);
+                        if (r.divisible) {
+                            n = r.quotient;
+                            s += exponent;
+                        }
+                    }
+                    else {
+                        while (true) {
+                            auto const r = try_divide<UInt, test, max_n, exponent>(n);
+                            if (r.divisible) {
+                                n = r.quotient;
+                                s += exponent;
+                            }
+                            else {
+                                break;
+                            }
+                        }
+                    }
+                }(),
+                ...);
+        }(std::make_index_sequence<schedule.size>{});
+        return {n, s};
+    }
+
+    template <class UInt, divisibility_test test, UInt max_n, chunk_schedule schedule>
+    constexpr remove_trailing_zeros_return<UInt> remove_trailing_zeros_branchless(UInt n) noexcept {
+        static_assert(is_valid_schedule<UInt, test, max_n, schedule>(true));
+        std::size_t s = 0;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (
+                [&] {
+                    constexpr auto exponent = schedule.exponents[I];
+                    auto const r = try_divide<UInt, test, max_n, exponent>(n);
+                    s += r.divisible ? exponent : 0;
+                    n = r.divisible ? r.quotient : n;
+                }(),
+                ...);
+        }(std::make_index_sequence<schedule.size>{});
+        return {n, s};
+    }
+
+    // Branchless binary search over the trailing zeros numbers up to max_n can have, e.g. 8-4-2-1
+    // for up to 15 trailing zeros. It is empty for numbers with a single digit.
+    template <class UInt>
+    constexpr chunk_schedule make_binary_search_schedule(UInt max_n) noexcept {
+        chunk_schedule schedule;
+        for (auto exponent = std::bit_floor(detail::number_of_digits(max_n) - 1); exponent != 0;
+             exponent /= 2) {
+            schedule.exponents[schedule.size++] = exponent;
+        }
+        return schedule;
+    }
+
+    template <class UInt, divisibility_test test, UInt max_n>
+    constexpr bool is_bounded_applicable() noexcept {
+        if constexpr (std::is_same_v<UInt, std::uint64_t> &&
+                      max_n <= std::numeric_limits<std::uint32_t>::max()) {
+            return is_bounded_applicable<std::uint32_t, test, std::uint32_t(max_n)>();
+        }
+        else if constexpr (max_n < 10) {
+            return true;
+        }
+        else {
+            return is_valid_schedule<UInt, test, max_n, make_binary_search_schedule(max_n)>(true);
+        }
+    }
+
+    // Branchless kernel for inputs known to be at most max_n, as for the significands of
+    // Dragonbox (at most 9 digits for float and 17 for double) or of BID decimals (7, 16 or 34):
+    //   - 64-bit inputs fitting in 32 bits are trimmed with 32-bit multiplications,
+    //   - only chunks for the trailing zeros possible below max_n are checked, and
+    //   - the constants are those for max_n, e.g. Lemire's test may need a smaller shift.
+    template <class UInt, divisibility_test test, UInt max_n>
+    constexpr remove_trailing_zeros_return<UInt> remove_trailing_zeros_bounded(UInt n) noexcept {
+        static_assert(is_bounded_applicable<UInt, test, max_n>());
+        if constexpr (std::is_same_v<UInt, std::uint64_t> &&
+                      max_n <= std::numeric_limits<std::uint32_t>::max()) {
+            auto const result =
+                remove_trailing_zeros_bounded<std::uint32_t, test, std::uint32_t(max_n)>(
+                    std::uint32_t(n));
+            return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros};
+        }
+        else if constexpr (max_n < 10) {
+            return {n, 0};
+        }
+        else {
+            // The exponents halve, so the count is built bit by bit as in the hand-written
+            // kernels, which compilers turn into fewer instructions than adding the exponents.
+            constexpr auto schedule = make_binary_search_schedule(max_n);
+            std::size_t s = 0;
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                (
+                    [&] {
+                        auto const r = try_divide<UInt, test, max_n, schedule.exponents[I]>(n);
+                        s = s * 2 + std::size_t(r.divisible);
+                        n = r.divisible ? r.quotient : n;
+                    }(),
+                    ...);
+            }(std::make_index_sequence<schedule.size>{});
+            return {n, s};
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,1147 @@
+#ifndef RTZ_BENCHMARK_REMOVE_TRAILING_ZEROS_HPP
+#define RTZ_BENCHMARK_REMOVE_TRAILING_ZEROS_HPP
+
+#include <rtz_benchmark/wuint.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// All kernels below assume a nonzero input, with at most 8 digits for alg32, at most 16 digits for
+// alg64 and at most 34 digits for alg128 unless noted otherwise, and are usable in constant
+// expressions. alg128 is only available if the compiler supports unsigned __int128.
+
+// n is assumed to be at most of bit_width bits.
+template <std::size_t bit_width, class UInt>
+constexpr UInt rotr(UInt n, unsigned int r) noexcept {
+    r &= (bit_width - 1);
+    return (n >> r) | (n << ((bit_width - r) & (bit_width - 1)));
+}
+
+template <class T>
+struct remove_trailing_zeros_return {
+    T trimmed_number;
+    std::size_t number_of_removed_zeros;
+    constexpr bool operator==(remove_trailing_zeros_return const&) const = default;
+};
+
+// Returned by the kernels also counting the decimal digits of the trimmed number.
+template <class T>
+struct trim_and_count_digits_return {
+    T trimmed_number;
+    std::size_t number_of_removed_zeros;
+    std::size_t number_of_remaining_digits;
+    constexpr bool operator==(trim_and_count_digits_return const&) const = default;
+};
+
+// Tables shared by the table-based kernels of alg32 and alg64.
+namespace table_detail {
+    // For k = 0, 1, ..., size - 1, the inverse of 5^k modulo 2^b and floor((2^b - 1) / 5^k). If
+    // n is divisible by 2^k, then n is divisible by 10^k iff (n >> k) * inverses[k] mod 2^b is at
+    // most max_quotients[k], which is then n / 10^k.
+    template <class UInt, std::size_t size>
+    struct power_of_5_table {
+        UInt inverses[size];
+        UInt max_quotients[size];
+    };
+
+    template <class UInt, std::size_t size>
+    constexpr power_of_5_table<UInt, size> make_power_of_5_table() noexcept {
+        power_of_5_table<UInt, size> table{};
+        UInt power_of_5 = 1;
+        for (std::size_t k = 0; k < size; ++k) {
+            // Each Newton step doubles the number of correct bits, starting from 3.
+            auto inverse = power_of_5;
+            for (int i = 0; i < 6; ++i) {
+                inverse = UInt(inverse * UInt(2 - power_of_5 * inverse));
+            }
+            table.inverses[k] = inverse;
+            table.max_quotients[k] = UInt(UInt(-1) / power_of_5);
+            power_of_5 = UInt(power_of_5 * 5);
+        }
+        return table;
+    }
+
+    // Enough for every number of trailing zeros a 32-bit or 64-bit integer can have.
+    inline constexpr auto power_of_5_table32 = make_power_of_5_table<std::uint32_t, 10>();
+    inline constexpr auto power_of_5_table64 = make_power_of_5_table<std::uint64_t, 20>();
+
+    // Number of trailing zeros of every residue modulo 10^4, with 4 for zero. 10KB, which fits in
+    // the L1 data cache of current CPUs.
+    inline constexpr auto residue_trailing_zeros = [] {
+        std::array<std::uint8_t, 10000> table{};
+        table[0] = 4;
+        for (std::size_t residue = 1; residue < table.size(); ++residue) {
+            auto n = residue;
+            while (n % 10 == 0) {
+                n /= 10;
+                ++table[residue];
+            }
+        }
+        return table;
+    }();
+}
+
+namespace digit_count_detail {
+    template <class UInt>
+    inline constexpr auto powers_of_10 = [] {
+        std::array<UInt, std::size_t(std::numeric_limits<UInt>::digits10) + 1> table{};
+        UInt power = 1;
+        for (auto& entry : table) {
+            entry = power;
+            power = UInt(power * 10);
+        }
+        return table;
+    }();
+
+    // floor(bit_width(n) * log10(2)) is the number of digits of n or one more, which the table
+    // decides. n must be nonzero; setting the lowest bit does not change the bit width then, but
+    // spares the compiler a branch around bsr/lzcnt for zero.
+    template <class UInt>
+    constexpr std::size_t count_digits(UInt n) noexcept {
+        auto const t = (std::size_t(std::bit_width(UInt(n | 1))) * 1233) >> 12;
+        return t + 1 - std::size_t(n < powers_of_10<UInt>[t]);
+    }
+
+    // The trimmed number has exactly as many digits as n minus the removed zeros. Counting the
+    // digits of n instead of the trimmed number takes the count off the dependency chain of the
+    // divisibility checks, so the two run in parallel.
+    template <auto kernel, class UInt>
+    constexpr trim_and_count_digits_return<UInt> trim_and_count_digits(UInt n) noexcept {
+        auto const number_of_digits = count_digits(n);
+        auto const result = kernel(n);
+        return {result.trimmed_number, result.number_of_removed_zeros,
+                number_of_digits - result.number_of_removed_zeros};
+    }
+}
+
+namespace alg32 {
+    constexpr remove_trailing_zeros_return<std::uint32_t> naive(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = n % 10;
+            if (r == 0) {
+                n /= 10;
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t> naive_2_1(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = n % 100;
+            if (r == 0) {
+                n /= 100;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = n % 10;
+        if (r == 0) {
+            n /= 10;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t> naive_branchless(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = n / 1'0000;
+        auto b = n % 1'0000 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = n / 100;
+        b = n % 100 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = n / 10;
+        b = n % 10 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    granlund_montgomery(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = rotr<32>(std::uint32_t(n * UINT32_C(3435973837)), 1);
+            if (r < UINT32_C(429496730)) {
+                n = r;
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    granlund_montgomery_2_1(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = rotr<32>(std::uint32_t(n * UINT32_C(42949673)), 2);
+            if (r < UINT32_C(42949673)) {
+                n = r;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = rotr<32>(std::uint32_t(n * UINT32_C(1288490189)), 1);
+        if (r < UINT32_C(429496730)) {
+            n = r;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    granlund_montgomery_branchless(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = rotr<32>(std::uint32_t(n * UINT32_C(184254097)), 4);
+        auto b = r < UINT32_C(429497);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = rotr<32>(std::uint32_t(n * UINT32_C(42949673)), 2);
+        b = r < UINT32_C(42949673);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = rotr<32>(std::uint32_t(n * UINT32_C(1288490189)), 1);
+        b = r < UINT32_C(429496730);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t> lemire(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint64_t(n * UINT64_C(429496730));
+            if (static_cast<std::uint32_t>(r) < UINT32_C(429496730)) {
+                n = std::uint32_t(r >> 32);
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t> lemire_2_1(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint64_t(n * UINT64_C(42949673));
+            if (static_cast<std::uint32_t>(r) < UINT32_C(42949673)) {
+                n = std::uint32_t(r >> 32);
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = std::uint64_t(n * UINT64_C(429496730));
+        if (static_cast<std::uint32_t>(r) < UINT32_C(429496730)) {
+            n = std::uint32_t(r >> 32);
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t> lemire_branchless(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = std::uint64_t(n * UINT64_C(109951163));
+        auto b = (r & ((std::uint64_t(1) << 40) - 1)) < UINT64_C(109951163);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 40) : n;
+
+        r = std::uint64_t(n * UINT64_C(42949673));
+        b = static_cast<std::uint32_t>(r) < UINT32_C(42949673);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 32) : n;
+
+        r = std::uint64_t(n * UINT64_C(429496730));
+        b = static_cast<std::uint32_t>(r) < UINT32_C(429496730);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 32) : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    generalized_granlund_montgomery(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint32_t(n * UINT32_C(1288490189));
+            if (r < UINT32_C(429496731)) {
+                n = std::uint32_t(r >> 1);
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    generalized_granlund_montgomery_2_1(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint32_t(n * UINT32_C(42949673));
+            if (r < UINT32_C(42949673)) {
+                n = std::uint32_t(r >> 2);
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = std::uint32_t(n * UINT32_C(1288490189));
+        if (r < UINT32_C(429496731)) {
+            n = std::uint32_t(r >> 1);
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint32_t>
+    generalized_granlund_montgomery_branchless(std::uint32_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = std::uint32_t(n * UINT32_C(184254097));
+        auto b = r < UINT32_C(429509);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 4) : n;
+
+        r = std::uint32_t(n * UINT32_C(42949673));
+        b = r < UINT32_C(42949673);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 2) : n;
+
+        r = std::uint32_t(n * UINT32_C(1288490189));
+        b = r < UINT32_C(429496731);
+        s = s * 2 + b;
+        n = b ? std::uint32_t(r >> 1) : n;
+
+        return {n, s};
+    }
+
+    // n has at most countr_zero(n) trailing zeros, and usually exactly that many or one or two
+    // fewer, so starting from there only a few divisibility checks are needed. Works for any
+    // number of digits.
+    constexpr remove_trailing_zeros_return<std::uint32_t> ctz_inverse_table(std::uint32_t n) noexcept {
+        auto const& table = table_detail::power_of_5_table32;
+        auto s = std::size_t(std::min(std::countr_zero(n), 9));
+        while (true) {
+            auto const q = std::uint32_t((n >> s) * table.inverses[s]);
+            if (q <= table.max_quotients[s]) {
+                return {q, s};
+            }
+            --s;
+        }
+    }
+
+    // Looks up the number of trailing zeros among the last four digits, and divides out 10^4
+    // only if all of them are zero. Works for any number of digits.
+    constexpr remove_trailing_zeros_return<std::uint32_t> residue_table(std::uint32_t n) noexcept {
+        auto const& table = table_detail::power_of_5_table32;
+        std::size_t s = 0;
+        while (true) {
+            auto const z = table_detail::residue_trailing_zeros[n % 1'0000];
+            if (z < 4) {
+                return {std::uint32_t((n >> z) * table.inverses[z]), s + z};
+            }
+            n /= 1'0000;
+            s += 4;
+        }
+    }
+
+    // The branchless kernels alongside a digit count of the input, which gives the number of digits
+    // of the trimmed number.
+    constexpr trim_and_count_digits_return<std::uint32_t>
+    naive_branchless_count_digits(std::uint32_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<naive_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint32_t>
+    granlund_montgomery_branchless_count_digits(std::uint32_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<granlund_montgomery_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint32_t>
+    lemire_branchless_count_digits(std::uint32_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<lemire_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint32_t>
+    generalized_granlund_montgomery_branchless_count_digits(std::uint32_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<generalized_granlund_montgomery_branchless>(n);
+    }
+}
+
+namespace split_detail {
+    // For n < 10^16, n = high * 10^8 + low with both halves below 10^8, so both are trimmed by
+    // the same 32-bit kernel with no dependency between the two, and no 64-bit multiplication
+    // besides the split itself. If low is nonzero, n has as many trailing zeros as low, and
+    // otherwise 8 more than high. A zero low is replaced by 1, which has no trailing zeros, so
+    // the table lookup stays in range and the results can be combined with masks; compilers
+    // tend to turn conditional operators here into a branch on low.
+    template <auto kernel32>
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    remove_trailing_zeros_split(std::uint64_t n) noexcept {
+        auto const high = std::uint32_t(n / 1'0000'0000);
+        auto const low = std::uint32_t(n - wuint::umul64(high, 1'0000'0000));
+        auto const low_is_zero = std::uint32_t(low == 0);
+
+        auto const high_result = kernel32(high);
+        auto const low_result = kernel32(low | low_is_zero);
+
+        auto const mask = std::uint64_t(0) - low_is_zero;
+        auto const trimmed_number =
+            wuint::umul64(high, digit_count_detail::powers_of_10<
+                                    std::uint32_t>[8 - low_result.number_of_removed_zeros]) +
+            low_result.trimmed_number;
+        return {(high_result.trimmed_number & mask) | (trimmed_number & ~mask),
+                low_result.number_of_removed_zeros +
+                    std::size_t((high_result.number_of_removed_zeros + 8) & mask)};
+    }
+}
+
+namespace alg64 {
+    constexpr remove_trailing_zeros_return<std::uint64_t> naive(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = n % 10;
+            if (r == 0) {
+                n /= 10;
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> naive_2_1(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = n % 100;
+            if (r == 0) {
+                n /= 100;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = n % 10;
+        if (r == 0) {
+            n /= 10;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> naive_8_2_1(std::uint64_t n) noexcept {
+        if (n % 100'000'000 == 0) {
+            // Is n divisible by 10^8?
+            // If yes, work with the quotient.
+            auto result = alg32::naive_2_1(std::uint32_t(n / 100'000'000));
+            return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+        }
+
+        std::size_t s = 0;
+        while (true) {
+            auto const r = n % 100;
+            if (r == 0) {
+                n /= 100;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = n % 10;
+        if (r == 0) {
+            n /= 10;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> naive_branchless(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = n / 1'0000'0000;
+        auto b = n % 1'0000'0000 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = n / 1'0000;
+        b = n % 1'0000 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = n / 100;
+        b = n % 100 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = n / 10;
+        b = n % 10 == 0;
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    granlund_montgomery(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
+            if (r < UINT64_C(1844674407370955162)) {
+                n = r;
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    granlund_montgomery_2_1(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
+            if (r < UINT64_C(184467440737095517)) {
+                n = r;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
+        if (r < UINT64_C(1844674407370955162)) {
+            n = r;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    granlund_montgomery_8_2_1(std::uint64_t n) noexcept {
+        {
+            // Is n divisible by 10^8?
+            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(28999941890838049)), 8);
+            if (r < UINT64_C(184467440738)) {
+                // If yes, work with the quotient.
+                auto result = alg32::granlund_montgomery_2_1(std::uint32_t(r));
+                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+            }
+        }
+
+        std::size_t s = 0;
+        while (true) {
+            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
+            if (r < UINT64_C(184467440737095517)) {
+                n = r;
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
+        if (r < UINT64_C(1844674407370955162)) {
+            n = r;
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    granlund_montgomery_branchless(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = rotr<64>(std::uint64_t(n * UINT64_C(28999941890838049)), 8);
+        auto b = r < UINT64_C(184467440738);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = rotr<64>(std::uint64_t(n * UINT64_C(182622766329724561)), 4);
+        b = r < UINT64_C(1844674407370956);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
+        b = r < UINT64_C(184467440737095517);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
+        b = r < UINT64_C(1844674407370955162);
+        s = s * 2 + b;
+        n = b ? r : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> lemire(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
+            if (r.low() < UINT64_C(1844674407370955162)) {
+                n = r.high();
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> lemire_2_1(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = wuint::umul128(n, UINT64_C(184467440737095517));
+            if (r.low() < UINT64_C(184467440737095517)) {
+                n = r.high();
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
+        if (r.low() < UINT64_C(1844674407370955162)) {
+            n = r.high();
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> lemire_8_2_1(std::uint64_t n) noexcept {
+        {
+            // Is n divisible by 10^8?
+            // 12089258196146292 = ceil(2^90 / 10^8).
+            // Works for n < 47'795'296'599'999'999.
+            auto r = wuint::umul128(n, UINT64_C(12089258196146292));
+            if ((r.high() & ((std::uint64_t(1) << (80 - 64)) - 1)) == 0 &&
+                r.low() < UINT64_C(12089258196146292)) {
+                // If yes, work with the quotient.
+                auto result = alg32::lemire_2_1(std::uint32_t(r.high() >> (80 - 64)));
+                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+            }
+        }
+
+        std::size_t s = 0;
+        while (true) {
+            auto const r = wuint::umul128(n, UINT64_C(184467440737095517));
+            if (r.low() < UINT64_C(184467440737095517)) {
+                n = r.high();
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
+        if (r.low() < UINT64_C(1844674407370955162)) {
+            n = r.high();
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> lemire_branchless(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = wuint::umul128(n, UINT64_C(12089258196146292));
+        auto b = (r.high() & ((std::uint64_t(1) << (80 - 64)) - 1)) == 0 &&
+                 r.low() < UINT64_C(12089258196146292);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r.high() >> (80 - 64)) : n;
+
+        r = wuint::umul128(n, UINT64_C(472236648286964522));
+        b = (r.high() & ((std::uint64_t(1) << (72 - 64)) - 1)) == 0 &&
+            r.low() < UINT64_C(472236648286964522);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r.high() >> (72 - 64)) : n;
+
+        r = wuint::umul128(n, UINT64_C(184467440737095517));
+        b = r.low() < UINT64_C(184467440737095517);
+        s = s * 2 + b;
+        n = b ? r.high() : n;
+
+        r = wuint::umul128(n, UINT64_C(1844674407370955162));
+        b = r.low() < UINT64_C(1844674407370955162);
+        s = s * 2 + b;
+        n = b ? r.high() : n;
+
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    generalized_granlund_montgomery(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
+            if (r < UINT64_C(1844674407370955163)) {
+                n = std::uint64_t(r >> 1);
+                s += 1;
+            }
+            else {
+                break;
+            }
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    generalized_granlund_montgomery_2_1(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint64_t(n * UINT64_C(14941862699704736809));
+            if (r < UINT64_C(184467440737095517)) {
+                n = std::uint64_t(r >> 2);
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
+        if (r < UINT64_C(1844674407370955163)) {
+            n = std::uint64_t(r >> 1);
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    generalized_granlund_montgomery_8_2_1(std::uint64_t n) noexcept {
+        {
+            // Is n divisible by 10^8?
+            auto const r = std::uint64_t(n * UINT64_C(28999941890838049));
+            if (r < UINT64_C(184467440969)) {
+                // If yes, work with the quotient.
+                auto result = alg32::generalized_granlund_montgomery_2_1(std::uint32_t(r >> 8));
+                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+            }
+        }
+
+        std::size_t s = 0;
+        while (true) {
+            auto const r = std::uint64_t(n * UINT64_C(14941862699704736809));
+            if (r < UINT64_C(184467440737095517)) {
+                n = std::uint64_t(r >> 2);
+                s += 2;
+            }
+            else {
+                break;
+            }
+        }
+        auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
+        if (r < UINT64_C(1844674407370955163)) {
+            n = std::uint64_t(r >> 1);
+            s += 1;
+        }
+        return {n, s};
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    generalized_granlund_montgomery_branchless(std::uint64_t n) noexcept {
+        std::size_t s = 0;
+
+        auto r = std::uint64_t(n * UINT64_C(28999941890838049));
+        auto b = r < UINT64_C(184467440969);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r >> 8) : n;
+
+        r = std::uint64_t(n * UINT64_C(182622766329724561));
+        b = r < UINT64_C(1844674407370971);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r >> 4) : n;
+
+        r = std::uint64_t(n * UINT64_C(14941862699704736809));
+        b = r < UINT64_C(184467440737095517);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r >> 2) : n;
+
+        r = std::uint64_t(n * UINT64_C(5534023222112865485));
+        b = r < UINT64_C(1844674407370955163);
+        s = s * 2 + b;
+        n = b ? std::uint64_t(r >> 1) : n;
+
+        return {n, s};
+    }
+
+    // n has at most countr_zero(n) trailing zeros, and usually exactly that many or one or two
+    // fewer, so starting from there only a few divisibility checks are needed. Works for any
+    // number of digits.
+    constexpr remove_trailing_zeros_return<std::uint64_t> ctz_inverse_table(std::uint64_t n) noexcept {
+        auto const& table = table_detail::power_of_5_table64;
+        auto s = std::size_t(std::min(std::countr_zero(n), 19));
+        while (true) {
+            auto const q = std::uint64_t((n >> s) * table.inverses[s]);
+            if (q <= table.max_quotients[s]) {
+                return {q, s};
+            }
+            --s;
+        }
+    }
+
+    // Looks up the number of trailing zeros among the last four digits, and divides out 10^4
+    // only if all of them are zero. Works for any number of digits.
+    constexpr remove_trailing_zeros_return<std::uint64_t> residue_table(std::uint64_t n) noexcept {
+        auto const& table = table_detail::power_of_5_table64;
+        std::size_t s = 0;
+        while (true) {
+            auto const z = table_detail::residue_trailing_zeros[n % 1'0000];
+            if (z < 4) {
+                return {std::uint64_t((n >> z) * table.inverses[z]), s + z};
+            }
+            n /= 1'0000;
+            s += 4;
+        }
+    }
+
+    // The branchless kernels alongside a digit count of the input, which gives the number of digits
+    // of the trimmed number.
+    constexpr trim_and_count_digits_return<std::uint64_t>
+    naive_branchless_count_digits(std::uint64_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<naive_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint64_t>
+    granlund_montgomery_branchless_count_digits(std::uint64_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<granlund_montgomery_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint64_t>
+    lemire_branchless_count_digits(std::uint64_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<lemire_branchless>(n);
+    }
+
+    constexpr trim_and_count_digits_return<std::uint64_t>
+    generalized_granlund_montgomery_branchless_count_digits(std::uint64_t n) noexcept {
+        return digit_count_detail::trim_and_count_digits<generalized_granlund_montgomery_branchless>(n);
+    }
+
+    // The input is split into two halves of 8 digits trimmed by the 32-bit branchless kernels.
+    constexpr remove_trailing_zeros_return<std::uint64_t> naive_split(std::uint64_t n) noexcept {
+        return split_detail::remove_trailing_zeros_split<alg32::naive_branchless>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    granlund_montgomery_split(std::uint64_t n) noexcept {
+        return split_detail::remove_trailing_zeros_split<alg32::granlund_montgomery_branchless>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> lemire_split(std::uint64_t n) noexcept {
+        return split_detail::remove_trailing_zeros_split<alg32::lemire_branchless>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t>
+    generalized_granlund_montgomery_split(std::uint64_t n) noexcept {
+        return split_detail::remove_trailing_zeros_split<
+            alg32::generalized_granlund_montgomery_branchless>(n);
+    }
+}
+
+#if defined(__SIZEOF_INT128__)
+namespace alg128 {
+    using wuint::builtin_uint128_t;
+
+    // The kernels differ only by how each chunk of zeros is tested and divided out, so the
+    // schedules are written once over sets of divisors for 10^1, 10^2, 10^4, ..., 10^32.
+    namespace detail {
+        constexpr builtin_uint128_t make_uint128(std::uint64_t high, std::uint64_t low) noexcept {
+            return (builtin_uint128_t(high) << 64) | low;
+        }
+
+        struct division_result {
+            builtin_uint128_t quotient;
+            bool divisible;
+        };
+
+        struct naive_divisor {
+            builtin_uint128_t divisor;
+            std::size_t exponent;
+        };
+
+        constexpr division_result try_divide(builtin_uint128_t n, naive_divisor const& d) noexcept {
+            return {n / d.divisor, n % d.divisor == 0};
+        }
+
+        // n is divisible by 10^k iff rotr(n * multiplier, k) < threshold, where multiplier is the
+        // inverse of 5^k and threshold is floor((2^128 - 1) / 10^k) + 1.
+        struct granlund_montgomery_divisor {
+            builtin_uint128_t multiplier;
+            builtin_uint128_t threshold;
+            std::size_t exponent;
+        };
+
+        constexpr division_result try_divide(builtin_uint128_t n,
+                                             granlund_montgomery_divisor const& d) noexcept {
+            auto const r = rotr<128>(builtin_uint128_t(n * d.multiplier), unsigned(d.exponent));
+            return {r, r < d.threshold};
+        }
+
+        // For n < 2^(128 - k), n is divisible by 10^k iff n * multiplier mod 2^128 < threshold,
+        // where multiplier is the inverse of 5^k + 2^(128 - k) and threshold is
+        // floor((2^(128 - k) - 1) / 5^k) + 1.
+        struct generalized_granlund_montgomery_divisor {
+            builtin_uint128_t multiplier;
+            builtin_uint128_t threshold;
+            std::size_t exponent;
+        };
+
+        constexpr division_result
+        try_divide(builtin_uint128_t n, generalized_granlund_montgomery_divisor const& d) noexcept {
+            auto const r = builtin_uint128_t(n * d.multiplier);
+            return {r >> d.exponent, r < d.threshold};
+        }
+
+        // multiplier = ceil(2^shift / 10^k), with the smallest shift of at least 128 such that n is
+        // divisible by 10^k iff the low shift bits of n * multiplier are below multiplier, for
+        // every n with at most 34 digits. The quotient is then n * multiplier >> shift.
+        struct lemire_divisor {
+            builtin_uint128_t multiplier;
+            std::size_t shift;
+            std::size_t exponent;
+        };
+
+        constexpr division_result try_divide(builtin_uint128_t n, lemire_divisor const& d) noexcept {
+            auto const r = wuint::umul256(n, d.multiplier);
+            if (d.shift == 128) {
+                return {r.high, r.low < d.multiplier};
+            }
+            return {r.high >> (d.shift - 128),
+                    (r.high & ((builtin_uint128_t(1) << (d.shift - 128)) - 1)) == 0 &&
+                        r.low < d.multiplier};
+        }
+
+        struct naive_divisors {
+            static constexpr naive_divisor d1 = {10, 1};
+            static constexpr naive_divisor d2 = {100, 2};
+            static constexpr naive_divisor d4 = {1'0000, 4};
+            static constexpr naive_divisor d8 = {1'0000'0000, 8};
+            static constexpr naive_divisor d16 = {1'0000'0000'0000'0000, 16};
+            static constexpr naive_divisor d32 = {
+                builtin_uint128_t(1'0000'0000'0000'0000) * 1'0000'0000'0000'0000, 32};
+        };
+
+        struct granlund_montgomery_divisors {
+            static constexpr granlund_montgomery_divisor d1 = {
+                make_uint128(UINT64_C(14757395258967641292), UINT64_C(14757395258967641293)),
+                make_uint128(UINT64_C(1844674407370955161), UINT64_C(11068046444225730970)), 1};
+            static constexpr granlund_montgomery_divisor d2 = {
+                make_uint128(UINT64_C(2951479051793528258), UINT64_C(10330176681277348905)),
+                make_uint128(UINT64_C(184467440737095516), UINT64_C(2951479051793528259)), 2};
+            static constexpr granlund_montgomery_divisor d4 = {
+                make_uint128(UINT64_C(5283147502710415582), UINT64_C(15170602326218735249)),
+                make_uint128(UINT64_C(1844674407370955), UINT64_C(2980993842311463542)), 4};
+            static constexpr granlund_montgomery_divisor d8 = {
+                make_uint128(UINT64_C(17540238603657894520), UINT64_C(14368461155438497313)),
+                make_uint128(UINT64_C(184467440737), UINT64_C(1761962158423493326)), 8};
+            static constexpr granlund_montgomery_divisor d16 = {
+                make_uint128(UINT64_C(17729319836977991782), UINT64_C(16475523416025833537)),
+                make_uint128(UINT64_C(1844), UINT64_C(12440620173433166434)), 16};
+            static constexpr granlund_montgomery_divisor d32 = {
+                make_uint128(UINT64_C(7112352118648041137), UINT64_C(1610335118080299137)),
+                make_uint128(UINT64_C(0), UINT64_C(3402824)), 32};
+        };
+
+        // The generalized test for 10^16 would need n < 2^112, which does not cover 34 digits, so
+        // 10^16 and 10^32 fall back to Granlund-Montgomery.
+        struct generalized_granlund_montgomery_divisors {
+            static constexpr generalized_granlund_montgomery_divisor d1 = {
+                make_uint128(UINT64_C(5534023222112865484), UINT64_C(14757395258967641293)),
+                make_uint128(UINT64_C(1844674407370955161), UINT64_C(11068046444225730970)), 1};
+            static constexpr generalized_granlund_montgomery_divisor d2 = {
+                make_uint128(UINT64_C(16786537107075691970), UINT64_C(10330176681277348905)),
+                make_uint128(UINT64_C(184467440737095516), UINT64_C(2951479051793528259)), 2};
+            static constexpr generalized_granlund_montgomery_divisor d4 = {
+                make_uint128(UINT64_C(4130225998103568606), UINT64_C(15170602326218735249)),
+                make_uint128(UINT64_C(1844674407370955), UINT64_C(2980993842311463542)), 4};
+            static constexpr generalized_granlund_montgomery_divisor d8 = {
+                make_uint128(UINT64_C(12856494991192578680), UINT64_C(14368461155438497313)),
+                make_uint128(UINT64_C(184467440737), UINT64_C(1761962158423493326)), 8};
+            static constexpr granlund_montgomery_divisor d16 = granlund_montgomery_divisors::d16;
+            static constexpr granlund_montgomery_divisor d32 = granlund_montgomery_divisors::d32;
+        };
+
+        struct lemire_divisors {
+            static constexpr lemire_divisor d1 = {
+                make_uint128(UINT64_C(1844674407370955161), UINT64_C(11068046444225730970)), 128,
+                1};
+            static constexpr lemire_divisor d2 = {
+                make_uint128(UINT64_C(184467440737095516), UINT64_C(2951479051793528259)), 128, 2};
+            static constexpr lemire_divisor d4 = {
+                make_uint128(UINT64_C(1844674407370955), UINT64_C(2980993842311463542)), 128, 4};
+            static constexpr lemire_divisor d8 = {
+                make_uint128(UINT64_C(377789318629571), UINT64_C(11383406077951765877)), 139, 8};
+            static constexpr lemire_divisor d16 = {
+                make_uint128(UINT64_C(126765060022822), UINT64_C(17342700359385365701)), 164, 16};
+            static constexpr lemire_divisor d32 = {
+                make_uint128(UINT64_C(456719261665907), UINT64_C(2987240860050737923)), 219, 32};
+        };
+
+        template <class Divisors>
+        constexpr remove_trailing_zeros_return<builtin_uint128_t>
+        remove_one_by_one(builtin_uint128_t n) noexcept {
+            std::size_t s = 0;
+            while (true) {
+                auto const r = try_divide(n, Divisors::d1);
+                if (r.divisible) {
+                    n = r.quotient;
+                    s += 1;
+                }
+                else {
+                    break;
+                }
+            }
+            return {n, s};
+        }
+
+        // Removes 10^16 as long as possible (at most twice for 34 digits), then each of 10^8, 10^4,
+        // 10^2 and 10 at most once.
+        template <class Divisors>
+        constexpr remove_trailing_zeros_return<builtin_uint128_t>
+        remove_16_8_4_2_1(builtin_uint128_t n) noexcept {
+            std::size_t s = 0;
+            while (true) {
+                auto const r = try_divide(n, Divisors::d16);
+                if (r.divisible) {
+                    n = r.quotient;
+                    s += 16;
+                }
+                else {
+                    break;
+                }
+            }
+            auto const remove_at_most_once = [&](auto const& divisor) {
+                auto const r = try_divide(n, divisor);
+                if (r.divisible) {
+                    n = r.quotient;
+                    s += divisor.exponent;
+                }
+            };
+            remove_at_most_once(Divisors::d8);
+            remove_at_most_once(Divisors::d4);
+            remove_at_most_once(Divisors::d2);
+            remove_at_most_once(Divisors::d1);
+            return {n, s};
+        }
+
+        // Branchless binary search over up to 63 trailing zeros, which covers 34 digits.
+        template <class Divisors>
+        constexpr remove_trailing_zeros_return<builtin_uint128_t>
+        remove_branchless(builtin_uint128_t n) noexcept {
+            std::size_t s = 0;
+            auto const step = [&](auto const& divisor) {
+                auto const r = try_divide(n, divisor);
+                s = s * 2 + r.divisible;
+                n = r.divisible ? r.quotient : n;
+            };
+            step(Divisors::d32);
+            step(Divisors::d16);
+            step(Divisors::d8);
+            step(Divisors::d4);
+            step(Divisors::d2);
+            step(Divisors::d1);
+            return {n, s};
+        }
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t> naive(builtin_uint128_t n) noexcept {
+        return detail::remove_one_by_one<detail::naive_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    naive_16_8_4_2_1(builtin_uint128_t n) noexcept {
+        return detail::remove_16_8_4_2_1<detail::naive_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    naive_branchless(builtin_uint128_t n) noexcept {
+        return detail::remove_branchless<detail::naive_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    granlund_montgomery(builtin_uint128_t n) noexcept {
+        return detail::remove_one_by_one<detail::granlund_montgomery_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    granlund_montgomery_16_8_4_2_1(builtin_uint128_t n) noexcept {
+        return detail::remove_16_8_4_2_1<detail::granlund_montgomery_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    granlund_montgomery_branchless(builtin_uint128_t n) noexcept {
+        return detail::remove_branchless<detail::granlund_montgomery_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t> lemire(builtin_uint128_t n) noexcept {
+        return detail::remove_one_by_one<detail::lemire_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    lemire_16_8_4_2_1(builtin_uint128_t n) noexcept {
+        return detail::remove_16_8_4_2_1<detail::lemire_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    lemire_branchless(builtin_uint128_t n) noexcept {
+        return detail::remove_branchless<detail::lemire_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    generalized_granlund_montgomery(builtin_uint128_t n) noexcept {
+        return detail::remove_one_by_one<detail::generalized_granlund_montgomery_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    generalized_granlund_montgomery_16_8_4_2_1(builtin_uint128_t n) noexcept {
+        return detail::remove_16_8_4_2_1<detail::generalized_granlund_montgomery_divisors>(n);
+    }
+
+    constexpr remove_trailing_zeros_return<builtin_uint128_t>
+    generalized_granlund_montgomery_branchless(builtin_uint128_t n) noexcept {
+        return detail::remove_branchless<detail::generalized_granlund_montgomery_divisors>(n);
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef RTZ_BENCHMARK_WUINT_HPP
+#define RTZ_BENCHMARK_WUINT_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// Guard the intrinsics below, which cannot be evaluated in constant expressions.
+#if defined(__cpp_if_consteval) && __cpp_if_consteval >= 202106L
+    #define RTZ_BENCHMARK_IF_CONSTEVAL if consteval
+    #define RTZ_BENCHMARK_IF_NOT_CONSTEVAL if !consteval
+#else
+    #define RTZ_BENCHMARK_IF_CONSTEVAL if (std::is_constant_evaluated())
+    #define RTZ_BENCHMARK_IF_NOT_CONSTEVAL if (!std::is_constant_evaluated())
+#endif
+
+namespace wuint {
+    // Compilers might support built-in 128-bit integer types. However, it seems that
+    // emulating them with a pair of 64-bit integers actually produces a better code,
+    // so we avoid using those built-ins. That said, they are still useful for
+    // implementing 64-bit x 64-bit -> 128-bit multiplication.
+
+    // clang-format off
+#if defined(__SIZEOF_INT128__)
+	// To silence "error: ISO C++ does not support '__int128' for 'type name'
+	// [-Wpedantic]"
+#if defined(__GNUC__)
+	__extension__
+#endif
+	using builtin_uint128_t = unsigned __int128;
+#endif
+    // clang-format on
+
+    struct uint128 {
+        uint128() = default;
+
+        std::uint64_t high_;
+        std::uint64_t low_;
+
+        constexpr uint128(std::uint64_t high, std::uint64_t low) noexcept : high_{high}, low_{low} {}
+
+        constexpr std::uint64_t high() const noexcept { return high_; }
+        constexpr std::uint64_t low() const noexcept { return low_; }
+    };
+
+    constexpr std::uint64_t umul64(std::uint32_t x, std::uint32_t y) noexcept {
+#if defined(_MSC_VER) && defined(_M_IX86)
+        RTZ_BENCHMARK_IF_NOT_CONSTEVAL { return __emulu(x, y); }
+#endif
+        return x * std::uint64_t(y);
+    }
+
+    constexpr uint128 umul128(std::uint64_t x, std::uint64_t y) noexcept {
+        auto const generic_impl = [=]() -> uint128 {
+            auto const a = std::uint32_t(x >> 32);
+            auto const b = std::uint32_t(x);
+            auto const c = std::uint32_t(y >> 32);
+            auto const d = std::uint32_t(y);
+
+            auto const ac = umul64(a, c);
+            auto const bc = umul64(b, c);
+            auto const ad = umul64(a, d);
+            auto const bd = umul64(b, d);
+
+            auto const intermediate = (bd >> 32) + std::uint32_t(ad) + std::uint32_t(bc);
+
+            return {ac + (intermediate >> 32) + (ad >> 32) + (bc >> 32),
+                    (intermediate << 32) + std::uint32_t(bd)};
+        };
+        // To silence warning.
+        static_cast<void>(generic_impl);
+
+        // Defining RTZ_BENCHMARK_FORCE_GENERIC_UMUL128 selects the portable implementation even
+        // if a faster one is available, so that its cost can be measured.
+#if defined(RTZ_BENCHMARK_FORCE_GENERIC_UMUL128)
+        return generic_impl();
+#elif defined(__SIZEOF_INT128__)
+        auto const result = builtin_uint128_t(x) * builtin_uint128_t(y);
+        return {std::uint64_t(result >> 64), std::uint64_t(result)};
+#elif defined(_MSC_VER) && defined(_M_X64)
+        RTZ_BENCHMARK_IF_CONSTEVAL {
+            // This redundant variable is to workaround MSVC's codegen bug caused by the
+            // interaction of NRVO and intrinsics.
+            auto const result = generic_impl();
+            return result;
+        }
+        uint128 result;
+    #if defined(__AVX2__)
+        result.low_ = _mulx_u64(x, y, &result.high_);
+    #else
+        result.low_ = _umul128(x, y, &result.high_);
+    #endif
+        return result;
+#else
+        return generic_impl();
+#endif
+    }
+
+#if defined(__SIZEOF_INT128__)
+    struct builtin_uint256 {
+        builtin_uint128_t high;
+        builtin_uint128_t low;
+    };
+
+    // 128-bit x 128-bit -> 256-bit multiplication, out of four 64-bit x 64-bit -> 128-bit ones.
+    constexpr builtin_uint256 umul256(builtin_uint128_t x, builtin_uint128_t y) noexcept {
+        auto const a = std::uint64_t(x >> 64);
+        auto const b = std::uint64_t(x);
+        auto const c = std::uint64_t(y >> 64);
+        auto const d = std::uint64_t(y);
+
+        auto const ac = builtin_uint128_t(a) * c;
+        auto const bc = builtin_uint128_t(b) * c;
+        auto const ad = builtin_uint128_t(a) * d;
+        auto const bd = builtin_uint128_t(b) * d;
+
+        auto const intermediate = (bd >> 64) + std::uint64_t(ad) + std::uint64_t(bc);
+
+        return {ac + (intermediate >> 64) + (ad >> 64) + (bc >> 64),
+                (intermediate << 64) + std::uint64_t(bd)};
+    }
+#endif
+}
+
+#endif
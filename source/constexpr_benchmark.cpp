@@ -0,0 +1,95 @@
+// Compiled by cmake/constexpr-benchmark.cmake once per kernel, without being linked: removes the
+// trailing zeros of a table of pseudo-random numbers with RTZ_BENCHMARK_CONSTEXPR_KERNEL during
+// compilation, so that the compile time of the kernels can be compared. The baseline kernels
+// leave the numbers unchanged, to measure the cost of the table itself.
+
+#include <rtz_benchmark/remove_trailing_zeros.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(RTZ_BENCHMARK_CONSTEXPR_KERNEL)
+    #define RTZ_BENCHMARK_CONSTEXPR_KERNEL alg64::lemire
+#endif
+#if !defined(RTZ_BENCHMARK_CONSTEXPR_TABLE_SIZE)
+    #define RTZ_BENCHMARK_CONSTEXPR_TABLE_SIZE 10000
+#endif
+
+namespace alg32 {
+    constexpr remove_trailing_zeros_return<std::uint32_t> baseline(std::uint32_t n) noexcept {
+        return {n, 0};
+    }
+}
+
+namespace alg64 {
+    constexpr remove_trailing_zeros_return<std::uint64_t> baseline(std::uint64_t n) noexcept {
+        return {n, 0};
+    }
+}
+
+namespace {
+    // Same as in main.cpp.
+    constexpr std::uint64_t splitmix64(std::uint64_t& state) noexcept {
+        state += UINT64_C(0x9e3779b97f4a7c15);
+        auto z = state;
+        z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31);
+    }
+
+    using uint_type = decltype(RTZ_BENCHMARK_CONSTEXPR_KERNEL(0).trimmed_number);
+
+    // The default number of digits of the runtime benchmark, which every kernel supports.
+    constexpr std::size_t max_digits = std::is_same_v<uint_type, std::uint32_t> ? 8 : 16;
+
+    // Numbers with at most max_digits digits and uniformly distributed numbers of trailing
+    // zeros.
+    constexpr auto inputs = [] {
+        auto const& powers_of_10 = digit_count_detail::powers_of_10<uint_type>;
+        std::array<uint_type, RTZ_BENCHMARK_CONSTEXPR_TABLE_SIZE> result{};
+        std::uint64_t state = 0;
+        for (auto& n : result) {
+            auto const trailing_zeros = splitmix64(state) % max_digits;
+            auto significand = splitmix64(state) % powers_of_10[max_digits - trailing_zeros];
+            if (significand % 10 == 0) {
+                ++significand;
+            }
+            n = uint_type(significand * powers_of_10[trailing_zeros]);
+        }
+        return result;
+    }();
+
+    constexpr auto table = [] {
+        std::array<remove_trailing_zeros_return<uint_type>, RTZ_BENCHMARK_CONSTEXPR_TABLE_SIZE>
+            result{};
+        for (std::size_t idx = 0; idx < inputs.size(); ++idx) {
+            result[idx] = RTZ_BENCHMARK_CONSTEXPR_KERNEL(inputs[idx]);
+        }
+        return result;
+    }();
+
+#if defined(RTZ_BENCHMARK_CONSTEXPR_CHECK)
+    constexpr remove_trailing_zeros_return<std::uint32_t> reference(std::uint32_t n) noexcept {
+        return alg32::naive(n);
+    }
+
+    constexpr remove_trailing_zeros_return<std::uint64_t> reference(std::uint64_t n) noexcept {
+        return alg64::naive(n);
+    }
+
+    constexpr bool matches_reference = [] {
+        for (std::size_t idx = 0; idx < inputs.size(); ++idx) {
+            if (table[idx] != reference(inputs[idx])) {
+                return false;
+            }
+        }
+        return true;
+    }();
+    static_assert(matches_reference, "the kernel disagrees with alg32::naive or alg64::naive");
+#endif
+}
+
+// Keeps the table referenced, in case the translation unit is compiled to an object file.
+std::size_t rtz_benchmark_constexpr_table_size() noexcept { return table.size(); }
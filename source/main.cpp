@@ -1,139 +1,135 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <random>
+#include <regex>
+#include <span>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-namespace wuint {
-    // Compilers might support built-in 128-bit integer types. However, it seems that
-    // emulating them with a pair of 64-bit integers actually produces a better code,
-    // so we avoid using those built-ins. That said, they are still useful for
-    // implementing 64-bit x 64-bit -> 128-bit multiplication.
-
-    // clang-format off
-#if defined(__SIZEOF_INT128__)
-	// To silence "error: ISO C++ does not support '__int128' for 'type name'
-	// [-Wpedantic]"
-#if defined(__GNUC__)
-	__extension__
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
 #endif
-	using builtin_uint128_t = unsigned __int128;
-#endif
-    // clang-format on
-
-    struct uint128 {
-        uint128() = default;
-
-        std::uint64_t high_;
-        std::uint64_t low_;
-
-        constexpr uint128(std::uint64_t high, std::uint64_t low) noexcept : high_{high}, low_{low} {}
-
-        constexpr std::uint64_t high() const noexcept { return high_; }
-        constexpr std::uint64_t low() const noexcept { return low_; }
-    };
 
-    std::uint64_t umul64(std::uint32_t x, std::uint32_t y) noexcept {
-#if defined(_MSC_VER) && defined(_M_IX86)
-        JKJ_IF_NOT_CONSTEVAL { return __emulu(x, y); }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <cpuid.h>
+    #include <x86intrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
 #endif
-        return x * std::uint64_t(y);
-    }
-
-    uint128 umul128(std::uint64_t x, std::uint64_t y) noexcept {
-        auto const generic_impl = [=]() -> uint128 {
-            auto const a = std::uint32_t(x >> 32);
-            auto const b = std::uint32_t(x);
-            auto const c = std::uint32_t(y >> 32);
-            auto const d = std::uint32_t(y);
 
-            auto const ac = umul64(a, c);
-            auto const bc = umul64(b, c);
-            auto const ad = umul64(a, d);
-            auto const bd = umul64(b, d);
-
-            auto const intermediate = (bd >> 32) + std::uint32_t(ad) + std::uint32_t(bc);
+// The time-stamp counter of interval_timer, fenced with lfence, which 32-bit x86 only has with
+// SSE2.
+#if (defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))) ||  \
+    (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+    #define RTZ_BENCHMARK_TIMESTAMP_COUNTER
+#endif
 
-            return {ac + (intermediate >> 32) + (ad >> 32) + (bc >> 32),
-                    (intermediate << 32) + std::uint32_t(bd)};
-        };
-        // To silence warning.
-        static_cast<void>(generic_impl);
+#include <rtz_benchmark/batch.hpp>
+#include <rtz_benchmark/bulk.hpp>
+#include <rtz_benchmark/dispatch.hpp>
+#include <rtz_benchmark/generated.hpp>
+#include <rtz_benchmark/remove_trailing_zeros.hpp>
+#include <rtz_benchmark/wuint.hpp>
 
-#if defined(__SIZEOF_INT128__)
-        auto const result = builtin_uint128_t(x) * builtin_uint128_t(y);
-        return {std::uint64_t(result >> 64), std::uint64_t(result)};
-#elif defined(_MSC_VER) && defined(_M_X64)
-        JKJ_IF_CONSTEVAL {
-            // This redundant variable is to workaround MSVC's codegen bug caused by the
-            // interaction of NRVO and intrinsics.
-            auto const result = generic_impl();
-            return result;
-        }
-        uint128 result;
-    #if defined(__AVX2__)
-        result.low_ = _mulx_u64(x, y, &result.high_);
-    #else
-        result.low_ = _umul128(x, y, &result.high_);
-    #endif
-        return result;
-#else
-        return generic_impl();
+// Set to the name of the variant by the benchmark matrix in cmake/benchmark-matrix.cmake.
+#if !defined(RTZ_BENCHMARK_BUILD_VARIANT)
+    #define RTZ_BENCHMARK_BUILD_VARIANT "default"
 #endif
-    }
+
+// Advances the state by the golden ratio and returns the mixed result.
+constexpr std::uint64_t splitmix64(std::uint64_t& state) noexcept {
+    state += UINT64_C(0x9e3779b97f4a7c15);
+    auto z = state;
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
 }
 
-// For correct seeding
-class repeating_seed_seq {
+// xoshiro256++ by Blackman and Vigna, which is several times faster than std::mt19937_64 with a
+// state of only 32 bytes.
+class xoshiro256_plus_plus {
 public:
-    using result_type = std::uint32_t;
+    using result_type = std::uint64_t;
 
-    repeating_seed_seq() : stored_values{0} {}
-    template <class InputIterator>
-    repeating_seed_seq(InputIterator first, InputIterator last) : stored_values(first, last) {}
-    template <class T>
-    repeating_seed_seq(std::initializer_list<T> list) : stored_values(list) {}
-
-    repeating_seed_seq(std::random_device&& rd, std::size_t count) {
-        stored_values.resize(count);
-        for (auto& elem : stored_values)
-            elem = rd();
-    }
-
-    template <class RandomAccessIterator>
-    void generate(RandomAccessIterator first, RandomAccessIterator last) {
-        auto count = last - first;
-        auto q = count / stored_values.size();
-        for (std::size_t i = 0; i < q; ++i) {
-            std::copy_n(stored_values.cbegin(), stored_values.size(), first);
-            first += stored_values.size();
+    // The state is expanded from the seed and the index of the stream with SplitMix64, so that
+    // streams can be generated independently of each other and in any order.
+    explicit xoshiro256_plus_plus(std::uint64_t seed, std::uint64_t stream = 0) noexcept {
+        auto splitmix_state = seed;
+        splitmix_state = splitmix64(splitmix_state) ^ stream;
+        for (auto& word : state_) {
+            word = splitmix64(splitmix_state);
         }
-        count -= q * stored_values.size();
-        std::copy_n(stored_values.cbegin(), count, first);
     }
 
-    std::size_t size() const noexcept { return stored_values.size(); }
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
 
-    template <class OutputIterator>
-    void param(OutputIterator first) const {
-        std::copy(stored_values.begin(), stored_values.end(), first);
+    result_type operator()() noexcept {
+        auto const result = std::rotl(state_[0] + state_[3], 23) + state_[0];
+        auto const t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
     }
 
 private:
-    std::vector<std::uint32_t> stored_values;
+    std::uint64_t state_[4];
 };
 
-std::mt19937_64 generate_correctly_seeded_mt19937_64() {
-    repeating_seed_seq seed_seq{std::random_device{}, std::mt19937_64::state_size *
-                                                          std::mt19937_64::word_size /
-                                                          (sizeof(std::uint32_t) * 8)};
-    return std::mt19937_64{seed_seq};
+std::uint64_t generate_random_seed() {
+    std::random_device rd;
+    return (std::uint64_t(rd()) << 32) | rd();
 }
 
+#if defined(__SIZEOF_INT128__)
+// The standard library cannot print 128-bit integers.
+std::ostream& operator<<(std::ostream& out, wuint::builtin_uint128_t n) {
+    char buffer[40];
+    auto const last = buffer + sizeof(buffer);
+    auto first = last;
+    do {
+        *--first = char('0' + int(n % 10));
+        n /= 10;
+    } while (n != 0);
+    return out << std::string_view(first, std::size_t(last - first));
+}
+#endif
+
 template <class Int>
 constexpr Int compute_power(Int a, std::size_t k) noexcept {
     auto result = Int{1};
@@ -147,765 +143,5360 @@ constexpr Int compute_power(Int a, std::size_t k) noexcept {
     return result;
 }
 
-template <class T>
-std::vector<T> generate_random_samples(std::size_t number_of_samples, std::size_t max_digits) {
-    auto rg = generate_correctly_seeded_mt19937_64();
-    std::uniform_int_distribution<std::size_t> digit_distribution{1, max_digits};
-    std::vector<T> samples(number_of_samples);
-
-    for (auto& sample : samples) {
-        auto const number_of_digits = digit_distribution(rg);
-        auto const number_of_trailing_zeros =
-            std::uniform_int_distribution<std::size_t>{0, number_of_digits - 1}(rg);
-        auto const multiplier = compute_power(T{10}, number_of_trailing_zeros);
-        auto const number_of_initial_digits = number_of_digits - number_of_trailing_zeros;
-        auto const minimum_initial_digits = compute_power(T{10}, number_of_initial_digits - 1);
-        auto const maximum_initial_digits = compute_power(T{10}, number_of_initial_digits) - 1;
-
-        sample = std::uniform_int_distribution<T>{minimum_initial_digits,
-                                                  maximum_initial_digits}(rg)*multiplier;
-    }
-
-    return samples;
-}
-
-// n is assumed to be at most of bit_width bits.
-template <std::size_t bit_width, class UInt>
-constexpr UInt rotr(UInt n, unsigned int r) noexcept {
-    r &= (bit_width - 1);
-    return (n >> r) | (n << ((bit_width - r) & (bit_width - 1)));
-}
-
-template <class T>
-struct remove_trailing_zeros_return {
-    T trimmed_number;
-    std::size_t number_of_removed_zeros;
-    constexpr bool operator==(remove_trailing_zeros_return const&) const = default;
-};
-
-namespace alg32 {
-    remove_trailing_zeros_return<std::uint32_t> naive(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = n % 10;
-            if (r == 0) {
-                n /= 10;
-                s += 1;
-            }
-            else {
-                break;
+// Uniformly random integer in [min, max]. Unlike std::uniform_int_distribution, which does not
+// support 128-bit integers either, the result only depends on the 64-bit outputs of the
+// generator, so the samples for a given seed are the same with every standard library.
+template <class T, class RandomGenerator>
+T generate_uniform_integer(T min, T max, RandomGenerator& rg) {
+    static_assert(RandomGenerator::min() == 0 &&
+                  RandomGenerator::max() == std::numeric_limits<std::uint64_t>::max());
+    auto const range = T(max - min);
+    if constexpr (sizeof(T) <= sizeof(std::uint64_t)) {
+        if (range == std::numeric_limits<std::uint64_t>::max()) {
+            return T(rg());
+        }
+        // Lemire's multiply-and-shift, rejecting the few products which would bias the result.
+        auto const bound = std::uint64_t(range) + 1;
+        auto product = wuint::umul128(rg(), bound);
+        if (product.low() < bound) {
+            auto const threshold = (0 - bound) % bound;
+            while (product.low() < threshold) {
+                product = wuint::umul128(rg(), bound);
             }
         }
-        return {n, s};
+        return T(min + product.high());
     }
-
-    remove_trailing_zeros_return<std::uint32_t> naive_2_1(std::uint32_t n) noexcept {
-        std::size_t s = 0;
+    else {
+        auto const range_high = std::uint64_t(range >> 64);
+        if (range_high == 0) {
+            return T(min + generate_uniform_integer(std::uint64_t(0), std::uint64_t(range), rg));
+        }
+        // Rejection sampling from the smallest power of 2 covering the range, which accepts at
+        // least half of the draws.
+        auto const mask = T(T(~T(0)) >> std::countl_zero(range_high));
         while (true) {
-            auto const r = n % 100;
-            if (r == 0) {
-                n /= 100;
-                s += 2;
-            }
-            else {
-                break;
+            auto const value = T(((T(rg()) << 64) | rg()) & mask);
+            if (value <= range) {
+                return T(min + value);
             }
         }
-        auto const r = n % 10;
-        if (r == 0) {
-            n /= 10;
-            s += 1;
-        }
-        return {n, s};
     }
+}
 
-    remove_trailing_zeros_return<std::uint32_t> naive_branchless(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = n / 1'0000;
-        auto b = n % 1'0000 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = n / 100;
-        b = n % 100 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
+enum class sample_distribution_kind {
+    // Uniformly random number of digits, then uniformly random number of trailing zeros.
+    uniform_digits_and_zeros,
+    // Uniformly random over all numbers with min_digits to max_digits digits.
+    uniform,
+    // Uniformly random number of digits, with a fixed number of trailing zeros.
+    fixed_trailing_zeros,
+    // Numbers of digits and trailing zeros drawn from a given histogram.
+    histogram,
+    // Significands Dragonbox would produce for random floats (for 32-bit) or doubles (for 64-bit).
+    dragonbox_realistic
+};
 
-        r = n / 10;
-        b = n % 10 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
+struct histogram_entry {
+    std::size_t number_of_digits;
+    std::size_t number_of_trailing_zeros;
+    double weight;
+};
 
-        return {n, s};
-    }
+struct sample_distribution {
+    sample_distribution_kind kind = sample_distribution_kind::uniform_digits_and_zeros;
+    // Used only for fixed_trailing_zeros.
+    std::size_t number_of_trailing_zeros = 0;
+    // Used only for histogram.
+    std::vector<histogram_entry> histogram;
+};
 
-    remove_trailing_zeros_return<std::uint32_t> granlund_montgomery(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = rotr<32>(std::uint32_t(n * UINT32_C(3435973837)), 1);
-            if (r < UINT32_C(429496730)) {
-                n = r;
-                s += 1;
-            }
-            else {
-                break;
-            }
-        }
-        return {n, s};
+std::string describe(sample_distribution const& distribution) {
+    switch (distribution.kind) {
+    case sample_distribution_kind::uniform_digits_and_zeros:
+        return "uniform number of digits and trailing zeros";
+    case sample_distribution_kind::uniform:
+        return "uniform";
+    case sample_distribution_kind::fixed_trailing_zeros:
+        return "exactly " + std::to_string(distribution.number_of_trailing_zeros) + " trailing zeros";
+    case sample_distribution_kind::histogram:
+        return "histogram of " + std::to_string(distribution.histogram.size()) + " entries";
+    case sample_distribution_kind::dragonbox_realistic:
+        return "Dragonbox-realistic";
     }
+    return {};
+}
 
-    remove_trailing_zeros_return<std::uint32_t> granlund_montgomery_2_1(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = rotr<32>(std::uint32_t(n * UINT32_C(42949673)), 2);
-            if (r < UINT32_C(42949673)) {
-                n = r;
-                s += 2;
-            }
-            else {
-                break;
-            }
+// Reads lines of the form "<number of digits> <number of trailing zeros> <weight>". Empty lines
+// and lines starting with '#' are ignored. Returns false if a line could not be parsed.
+bool read_histogram(std::istream& in, std::vector<histogram_entry>& histogram) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
         }
-        auto const r = rotr<32>(std::uint32_t(n * UINT32_C(1288490189)), 1);
-        if (r < UINT32_C(429496730)) {
-            n = r;
-            s += 1;
+        std::istringstream line_stream{line};
+        histogram_entry entry;
+        if (!(line_stream >> entry.number_of_digits >> entry.number_of_trailing_zeros >>
+              entry.weight)) {
+            return false;
         }
-        return {n, s};
+        histogram.push_back(entry);
     }
+    return true;
+}
 
-    remove_trailing_zeros_return<std::uint32_t>
-    granlund_montgomery_branchless(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = rotr<32>(std::uint32_t(n * UINT32_C(184254097)), 4);
-        auto b = r < UINT32_C(429497);
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = rotr<32>(std::uint32_t(n * UINT32_C(42949673)), 2);
-        b = r < UINT32_C(42949673);
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = rotr<32>(std::uint32_t(n * UINT32_C(1288490189)), 1);
-        b = r < UINT32_C(429496730);
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        return {n, s};
+// Returns an empty string if the distribution can be sampled, or an error message otherwise.
+template <class T>
+std::string check_sample_distribution(sample_distribution const& distribution,
+                                      std::size_t min_digits, std::size_t max_digits) {
+    if (max_digits == 0 || max_digits > std::size_t(std::numeric_limits<T>::digits10)) {
+        return "max_digits must be between 1 and " +
+               std::to_string(std::numeric_limits<T>::digits10);
     }
-
-    remove_trailing_zeros_return<std::uint32_t> lemire(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint64_t(n * UINT64_C(429496730));
-            if (static_cast<std::uint32_t>(r) < UINT32_C(429496730)) {
-                n = std::uint32_t(r >> 32);
-                s += 1;
-            }
-            else {
-                break;
-            }
-        }
-        return {n, s};
+    if (min_digits == 0 || min_digits > max_digits) {
+        return "min_digits must be between 1 and max_digits";
     }
-
-    remove_trailing_zeros_return<std::uint32_t> lemire_2_1(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint64_t(n * UINT64_C(42949673));
-            if (static_cast<std::uint32_t>(r) < UINT32_C(42949673)) {
-                n = std::uint32_t(r >> 32);
-                s += 2;
-            }
-            else {
-                break;
-            }
+    if (distribution.kind == sample_distribution_kind::fixed_trailing_zeros &&
+        distribution.number_of_trailing_zeros >= max_digits) {
+        return "the number of trailing zeros must be less than max_digits";
+    }
+    if (distribution.kind == sample_distribution_kind::dragonbox_realistic &&
+        sizeof(T) > sizeof(std::uint64_t)) {
+        return "the Dragonbox-realistic distribution is only available for 32-bit and 64-bit";
+    }
+    if (distribution.kind == sample_distribution_kind::histogram) {
+        if (distribution.histogram.empty()) {
+            return "the histogram is empty";
         }
-        auto const r = std::uint64_t(n * UINT64_C(429496730));
-        if (static_cast<std::uint32_t>(r) < UINT32_C(429496730)) {
-            n = std::uint32_t(r >> 32);
-            s += 1;
+        for (auto const& entry : distribution.histogram) {
+            if (entry.number_of_digits < min_digits || entry.number_of_digits > max_digits ||
+                entry.number_of_trailing_zeros >= entry.number_of_digits || !(entry.weight >= 0)) {
+                return "invalid histogram entry (" + std::to_string(entry.number_of_digits) + ", " +
+                       std::to_string(entry.number_of_trailing_zeros) + ")";
+            }
         }
-        return {n, s};
     }
+    return {};
+}
 
-    remove_trailing_zeros_return<std::uint32_t> lemire_branchless(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = std::uint64_t(n * UINT64_C(109951163));
-        auto b = (r & ((std::uint64_t(1) << 40) - 1)) < UINT64_C(109951163);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 40) : n;
+// Uniformly randomly generates an unsigned integer with given total number of digits and the
+// number of trailing zeros. If exact_trailing_zeros is false, the digits in front of the trailing
+// zeros may end with zeros as well.
+template <class T, class RandomGenerator>
+T generate_sample(std::size_t number_of_digits, std::size_t number_of_trailing_zeros,
+                  bool exact_trailing_zeros, RandomGenerator& rg) {
+    auto const multiplier = compute_power(T{10}, number_of_trailing_zeros);
+    auto const number_of_initial_digits = number_of_digits - number_of_trailing_zeros;
+    auto const minimum_initial_digits = compute_power(T{10}, number_of_initial_digits - 1);
+    auto const maximum_initial_digits = compute_power(T{10}, number_of_initial_digits) - 1;
 
-        r = std::uint64_t(n * UINT64_C(42949673));
-        b = static_cast<std::uint32_t>(r) < UINT32_C(42949673);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 32) : n;
+    auto initial_digits = generate_uniform_integer(minimum_initial_digits, maximum_initial_digits, rg);
+    while (exact_trailing_zeros && initial_digits % 10 == 0) {
+        initial_digits = generate_uniform_integer(minimum_initial_digits, maximum_initial_digits, rg);
+    }
+    return initial_digits * multiplier;
+}
 
-        r = std::uint64_t(n * UINT64_C(429496730));
-        b = static_cast<std::uint32_t>(r) < UINT32_C(429496730);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 32) : n;
+template <class UInt>
+struct shortest_representation {
+    UInt significand;
+    std::size_t number_of_digits;
+    // Decimal exponent of the leading digit.
+    int exponent;
+};
 
-        return {n, s};
-    }
+// Shortest round-trip decimal significand of a positive finite floating-point number.
+template <class UInt, class Float>
+shortest_representation<UInt> compute_shortest_representation(Float x) {
+    char buffer[64];
+    auto const last =
+        std::to_chars(buffer, buffer + sizeof(buffer), x, std::chars_format::scientific).ptr;
 
-    remove_trailing_zeros_return<std::uint32_t>
-    generalized_granlund_montgomery(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint32_t(n * UINT32_C(1288490189));
-            if (r < UINT32_C(429496731)) {
-                n = std::uint32_t(r >> 1);
-                s += 1;
-            }
-            else {
-                break;
-            }
+    shortest_representation<UInt> result{0, 0, 0};
+    auto ptr = buffer;
+    for (; ptr != last && *ptr != 'e'; ++ptr) {
+        if (*ptr != '.') {
+            result.significand = result.significand * 10 + UInt(*ptr - '0');
+            ++result.number_of_digits;
         }
-        return {n, s};
     }
+    // Skip the 'e' and the '+', which std::from_chars does not accept.
+    ptr += ptr[1] == '+' ? 2 : 1;
+    std::from_chars(ptr, last, result.exponent);
+    return result;
+}
 
-    remove_trailing_zeros_return<std::uint32_t>
-    generalized_granlund_montgomery_2_1(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint32_t(n * UINT32_C(42949673));
-            if (r < UINT32_C(42949673)) {
-                n = std::uint32_t(r >> 2);
-                s += 2;
-            }
-            else {
-                break;
-            }
-        }
-        auto const r = std::uint32_t(n * UINT32_C(1288490189));
-        if (r < UINT32_C(429496731)) {
-            n = std::uint32_t(r >> 1);
-            s += 1;
-        }
-        return {n, s};
+// Pads the shortest representation of x with trailing zeros up to max_digits digits, as
+// Dragonbox would. Returns std::nullopt for zero, infinities and NaNs, and if the shortest
+// representation does not have min_digits to max_digits digits.
+template <class T, class Float>
+std::optional<T> compute_dragonbox_significand(Float x, std::size_t min_digits,
+                                               std::size_t max_digits) {
+    x = std::abs(x);
+    if (!std::isfinite(x) || x == 0) {
+        return std::nullopt;
     }
+    auto const shortest = compute_shortest_representation<T>(x);
+    if (shortest.number_of_digits < min_digits || shortest.number_of_digits > max_digits) {
+        return std::nullopt;
+    }
+    return shortest.significand * compute_power(T{10}, max_digits - shortest.number_of_digits);
+}
 
-    remove_trailing_zeros_return<std::uint32_t>
-    generalized_granlund_montgomery_branchless(std::uint32_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = std::uint32_t(n * UINT32_C(184254097));
-        auto b = r < UINT32_C(429509);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 4) : n;
+// A significand as Dragonbox would pass it to trailing zero removal, together with what is needed
+// to print the number afterwards.
+template <class T>
+struct pipeline_sample {
+    T significand;
+    // The absolute value is significand * 10^exponent.
+    int exponent;
+    bool negative;
+};
 
-        r = std::uint32_t(n * UINT32_C(42949673));
-        b = r < UINT32_C(42949673);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 2) : n;
+// Same as compute_dragonbox_significand, with the exponent and the sign.
+template <class T, class Float>
+std::optional<pipeline_sample<T>> make_pipeline_sample(Float x, std::size_t min_digits,
+                                                       std::size_t max_digits) {
+    auto const significand = compute_dragonbox_significand<T>(x, min_digits, max_digits);
+    if (!significand) {
+        return std::nullopt;
+    }
+    auto const shortest = compute_shortest_representation<T>(std::abs(x));
+    return pipeline_sample<T>{*significand, shortest.exponent - int(max_digits) + 1,
+                              std::signbit(x)};
+}
 
-        r = std::uint32_t(n * UINT32_C(1288490189));
-        b = r < UINT32_C(429496731);
-        s = s * 2 + b;
-        n = b ? std::uint32_t(r >> 1) : n;
+// Dragonbox computes the significand at a fixed decimal exponent and removes trailing zeros only
+// afterwards. We emulate this by padding the shortest representation of a uniformly random bit
+// pattern with trailing zeros up to max_digits digits, rejecting those whose shortest
+// representation does not have min_digits to max_digits digits.
+template <class T, class RandomGenerator>
+T generate_dragonbox_realistic_sample(std::size_t min_digits, std::size_t max_digits,
+                                      RandomGenerator& rg) {
+    using float_type = std::conditional_t<sizeof(T) == sizeof(float), float, double>;
+    using bits_type = std::conditional_t<sizeof(T) == sizeof(float), std::uint32_t, std::uint64_t>;
 
-        return {n, s};
+    while (true) {
+        auto const bits = bits_type(rg());
+        if (auto const sample = compute_dragonbox_significand<T>(std::bit_cast<float_type>(bits),
+                                                                 min_digits, max_digits)) {
+            return *sample;
+        }
     }
+}
 
-    remove_trailing_zeros_return<std::uint32_t> baseline(std::uint32_t n) noexcept { return {n, 0}; }
+// Prints which share of the finite nonzero random floats (for 32-bit) or doubles (for 64-bit)
+// is dropped for a shortest representation without min_digits to max_digits digits, so that a
+// Dragonbox-realistic run does not pass for all of them. With the default --max-digits, these
+// are the 9-digit floats and the 17-digit doubles, which not every candidate supports.
+void print_dragonbox_rejection_rate(char const* float_name, std::uint64_t number_of_rejected,
+                                    std::uint64_t number_of_considered, std::size_t min_digits,
+                                    std::size_t max_digits) {
+    std::cout << "Note: " << std::fixed << std::setprecision(1)
+              << 100 * double(number_of_rejected) / double(std::max(number_of_considered,
+                                                                    std::uint64_t(1)))
+              << std::defaultfloat << std::setprecision(6) << "% of the finite nonzero random "
+              << float_name << "s are skipped for having a shortest representation without "
+              << min_digits << " to " << max_digits << " digits.\n";
 }
 
-namespace alg64 {
-    remove_trailing_zeros_return<std::uint64_t> naive(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = n % 10;
-            if (r == 0) {
-                n /= 10;
-                s += 1;
+// Same as print_dragonbox_rejection_rate for the Dragonbox-realistic distribution, estimated on
+// a fixed sample of bit patterns; prints nothing for other distributions.
+template <class T>
+void print_sample_distribution_notes(sample_distribution const& distribution,
+                                     std::size_t min_digits, std::size_t max_digits) {
+    if constexpr (sizeof(T) <= sizeof(std::uint64_t)) {
+        if (distribution.kind != sample_distribution_kind::dragonbox_realistic) {
+            return;
+        }
+        using float_type = std::conditional_t<sizeof(T) == sizeof(float), float, double>;
+        using bits_type =
+            std::conditional_t<sizeof(T) == sizeof(float), std::uint32_t, std::uint64_t>;
+        xoshiro256_plus_plus rg{0};
+        std::uint64_t number_of_considered = 0;
+        std::uint64_t number_of_rejected = 0;
+        for (std::size_t idx = 0; idx < 100000; ++idx) {
+            auto const x = std::bit_cast<float_type>(bits_type(rg()));
+            if (!std::isfinite(x) || x == 0) {
+                continue;
             }
-            else {
-                break;
+            ++number_of_considered;
+            if (!compute_dragonbox_significand<T>(x, min_digits, max_digits)) {
+                ++number_of_rejected;
             }
         }
-        return {n, s};
+        print_dragonbox_rejection_rate(sizeof(T) == sizeof(float) ? "float" : "double",
+                                       number_of_rejected, number_of_considered, min_digits,
+                                       max_digits);
+    }
+    else {
+        static_cast<void>(distribution);
+        static_cast<void>(min_digits);
+        static_cast<void>(max_digits);
     }
+}
 
-    remove_trailing_zeros_return<std::uint64_t> naive_2_1(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = n % 100;
-            if (r == 0) {
-                n /= 100;
-                s += 2;
-            }
-            else {
-                break;
-            }
+template <class T, class RandomGenerator>
+void generate_random_samples(std::span<T> samples, std::size_t min_digits, std::size_t max_digits,
+                             sample_distribution const& distribution, RandomGenerator& rg) {
+    switch (distribution.kind) {
+    case sample_distribution_kind::uniform_digits_and_zeros: {
+        for (auto& sample : samples) {
+            auto const number_of_digits = generate_uniform_integer(min_digits, max_digits, rg);
+            auto const number_of_trailing_zeros =
+                generate_uniform_integer(std::size_t(0), number_of_digits - 1, rg);
+            sample = generate_sample<T>(number_of_digits, number_of_trailing_zeros, false, rg);
         }
-        auto const r = n % 10;
-        if (r == 0) {
-            n /= 10;
-            s += 1;
+        break;
+    }
+
+    case sample_distribution_kind::uniform: {
+        auto const min_sample = compute_power(T{10}, min_digits - 1);
+        auto const max_sample = T(compute_power(T{10}, max_digits) - 1);
+        for (auto& sample : samples) {
+            sample = generate_uniform_integer(min_sample, max_sample, rg);
         }
-        return {n, s};
+        break;
     }
 
-    remove_trailing_zeros_return<std::uint64_t> naive_8_2_1(std::uint64_t n) noexcept {
-        if (n % 100'000'000 == 0) {
-            // Is n divisible by 10^8?
-            // If yes, work with the quotient.
-            auto result = alg32::naive_2_1(std::uint32_t(n / 100'000'000));
-            return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+    case sample_distribution_kind::fixed_trailing_zeros: {
+        auto const min_digits_with_zeros =
+            std::max(distribution.number_of_trailing_zeros + 1, min_digits);
+        for (auto& sample : samples) {
+            sample = generate_sample<T>(generate_uniform_integer(min_digits_with_zeros, max_digits, rg),
+                                        distribution.number_of_trailing_zeros, true, rg);
         }
+        break;
+    }
 
-        std::size_t s = 0;
-        while (true) {
-            auto const r = n % 100;
-            if (r == 0) {
-                n /= 100;
-                s += 2;
-            }
-            else {
-                break;
-            }
+    case sample_distribution_kind::histogram: {
+        // Entries are drawn by where a uniformly random number below the total weight falls among
+        // the partial sums, which std::discrete_distribution does differently on each standard
+        // library.
+        std::vector<double> partial_sums;
+        double total_weight = 0;
+        for (auto const& entry : distribution.histogram) {
+            total_weight += entry.weight;
+            partial_sums.push_back(total_weight);
         }
-        auto const r = n % 10;
-        if (r == 0) {
-            n /= 10;
-            s += 1;
+        for (auto& sample : samples) {
+            auto const position = double(rg() >> 11) * 0x1p-53 * total_weight;
+            auto const entry_idx = std::size_t(
+                std::upper_bound(partial_sums.cbegin(), partial_sums.cend(), position) -
+                partial_sums.cbegin());
+            // Rounding may put the position at the total weight.
+            auto const& entry = distribution.histogram[std::min(entry_idx, partial_sums.size() - 1)];
+            sample = generate_sample<T>(entry.number_of_digits, entry.number_of_trailing_zeros,
+                                        true, rg);
         }
-        return {n, s};
+        break;
     }
 
-    remove_trailing_zeros_return<std::uint64_t> naive_branchless(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = n / 1'0000'0000;
-        auto b = n % 1'0000'0000 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = n / 1'0000;
-        b = n % 1'0000 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = n / 100;
-        b = n % 100 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
+    case sample_distribution_kind::dragonbox_realistic:
+        for (auto& sample : samples) {
+            sample = generate_dragonbox_realistic_sample<T>(min_digits, max_digits, rg);
+        }
+        break;
+    }
+}
 
-        r = n / 10;
-        b = n % 10 == 0;
-        s = s * 2 + b;
-        n = b ? r : n;
+enum class sample_file_format {
+    // Unsigned integers of the benchmarked width, in native byte order.
+    binary,
+    // Decimal unsigned integers separated by whitespace.
+    text,
+    // IEEE-754 floats or doubles in native byte order, converted to the significands Dragonbox
+    // would produce as for the Dragonbox-realistic distribution.
+    binary_float,
+    binary_double
+};
 
-        return {n, s};
+constexpr char const* name_of(sample_file_format format) noexcept {
+    switch (format) {
+    case sample_file_format::binary:
+        return "binary";
+    case sample_file_format::text:
+        return "text";
+    case sample_file_format::binary_float:
+        return "float";
+    case sample_file_format::binary_double:
+        return "double";
     }
+    return "";
+}
 
-    remove_trailing_zeros_return<std::uint64_t> granlund_montgomery(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
-            if (r < UINT64_C(1844674407370955162)) {
-                n = r;
-                s += 1;
-            }
-            else {
-                break;
-            }
+// Reads samples from a file in chunks of chunk_size. The next chunk is read on a background
+// thread while the current one is processed, so that reading does not show up in the timing and
+// files much larger than memory can be used. Zero and numbers without min_digits to max_digits
+// digits are skipped, since some candidates do not even terminate on them.
+template <class T>
+class sample_file_reader {
+public:
+    sample_file_reader(std::string const& path, sample_file_format format, std::size_t min_digits,
+                       std::size_t max_digits, std::size_t chunk_size)
+        : file_{path, std::ios::binary}, opened_{file_.is_open()}, format_{format},
+          min_digits_{min_digits}, max_digits_{max_digits},
+          min_value_{compute_power(T{10}, min_digits - 1)},
+          max_value_{T(compute_power(T{10}, max_digits) - 1)}, chunk_size_{chunk_size} {
+        if (opened_) {
+            start_reading();
         }
-        return {n, s};
     }
 
-    remove_trailing_zeros_return<std::uint64_t> granlund_montgomery_2_1(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
-            if (r < UINT64_C(184467440737095517)) {
-                n = r;
-                s += 2;
-            }
-            else {
-                break;
+    bool is_open() const noexcept { return opened_; }
+    std::size_t min_digits() const noexcept { return min_digits_; }
+    std::size_t max_digits() const noexcept { return max_digits_; }
+
+    // Returns an empty chunk at the end of the file or after an error. The chunk stays valid until
+    // the next call.
+    std::span<T const> next_chunk() {
+        current_chunk_.clear();
+        if (pending_chunk_.valid()) {
+            current_chunk_ = pending_chunk_.get();
+            if (!current_chunk_.empty()) {
+                start_reading();
             }
         }
-        auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
-        if (r < UINT64_C(1844674407370955162)) {
-            n = r;
-            s += 1;
-        }
-        return {n, s};
+        return current_chunk_;
     }
 
-    remove_trailing_zeros_return<std::uint64_t> granlund_montgomery_8_2_1(std::uint64_t n) noexcept {
-        {
-            // Is n divisible by 10^8?
-            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(28999941890838049)), 8);
-            if (r < UINT64_C(184467440738)) {
-                // If yes, work with the quotient.
-                auto result = alg32::granlund_montgomery_2_1(std::uint32_t(r));
-                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
-            }
+    // Blocks until the next chunk has been read, so that reading it does not compete for the CPU
+    // with what the caller is about to time.
+    void wait_for_next_chunk() const {
+        if (pending_chunk_.valid()) {
+            pending_chunk_.wait();
         }
+    }
 
-        std::size_t s = 0;
-        while (true) {
-            auto const r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
-            if (r < UINT64_C(184467440737095517)) {
-                n = r;
-                s += 2;
-            }
-            else {
-                break;
-            }
+    // Starts over from the first chunk.
+    void rewind() {
+        if (pending_chunk_.valid()) {
+            pending_chunk_.wait();
         }
-        auto const r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
-        if (r < UINT64_C(1844674407370955162)) {
-            n = r;
-            s += 1;
-        }
-        return {n, s};
+        file_.clear();
+        file_.seekg(0);
+        number_of_skipped_samples_ = 0;
+        error_.clear();
+        start_reading();
     }
 
-    remove_trailing_zeros_return<std::uint64_t>
-    granlund_montgomery_branchless(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = rotr<64>(std::uint64_t(n * UINT64_C(28999941890838049)), 8);
-        auto b = r < UINT64_C(184467440738);
-        s = s * 2 + b;
-        n = b ? r : n;
+    // These are only up to date once next_chunk returned an empty chunk.
+    std::uint64_t number_of_skipped_samples() const noexcept { return number_of_skipped_samples_; }
+    // Empty unless the file could not be read or parsed.
+    std::string const& error() const noexcept { return error_; }
 
-        r = rotr<64>(std::uint64_t(n * UINT64_C(182622766329724561)), 4);
-        b = r < UINT64_C(1844674407370956);
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = rotr<64>(std::uint64_t(n * UINT64_C(10330176681277348905)), 2);
-        b = r < UINT64_C(184467440737095517);
-        s = s * 2 + b;
-        n = b ? r : n;
-
-        r = rotr<64>(std::uint64_t(n * UINT64_C(14757395258967641293)), 1);
-        b = r < UINT64_C(1844674407370955162);
-        s = s * 2 + b;
-        n = b ? r : n;
+private:
+    void start_reading() {
+        pending_chunk_ = std::async(std::launch::async, [this] { return read_chunk(); });
+    }
 
-        return {n, s};
+    std::vector<T> read_chunk() {
+        std::vector<T> chunk;
+        chunk.reserve(chunk_size_);
+        switch (format_) {
+        case sample_file_format::binary:
+            read_binary<T>(chunk, [](T n) { return std::optional<T>{n}; });
+            break;
+        case sample_file_format::text:
+            read_text(chunk);
+            break;
+        case sample_file_format::binary_float:
+            read_binary<float>(chunk, [this](float x) {
+                return compute_dragonbox_significand<T>(x, min_digits_, max_digits_);
+            });
+            break;
+        case sample_file_format::binary_double:
+            read_binary<double>(chunk, [this](double x) {
+                return compute_dragonbox_significand<T>(x, min_digits_, max_digits_);
+            });
+            break;
+        }
+        return chunk;
     }
 
-    remove_trailing_zeros_return<std::uint64_t> lemire(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
-            if (r.low() < UINT64_C(1844674407370955162)) {
-                n = r.high();
-                s += 1;
-            }
-            else {
-                break;
-            }
+    void accept(std::vector<T>& chunk, std::optional<T> sample) {
+        if (sample && *sample >= min_value_ && *sample <= max_value_) {
+            chunk.push_back(*sample);
+        }
+        else {
+            ++number_of_skipped_samples_;
         }
-        return {n, s};
     }
 
-    remove_trailing_zeros_return<std::uint64_t> lemire_2_1(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = wuint::umul128(n, UINT64_C(184467440737095517));
-            if (r.low() < UINT64_C(184467440737095517)) {
-                n = r.high();
-                s += 2;
+    template <class Raw, class Convert>
+    void read_binary(std::vector<T>& chunk, Convert const& convert) {
+        std::vector<Raw> buffer;
+        while (chunk.size() < chunk_size_ && file_) {
+            buffer.resize(chunk_size_ - chunk.size());
+            file_.read(reinterpret_cast<char*>(buffer.data()),
+                       std::streamsize(buffer.size() * sizeof(Raw)));
+            auto const number_of_bytes = std::size_t(file_.gcount());
+            for (std::size_t idx = 0; idx < number_of_bytes / sizeof(Raw); ++idx) {
+                accept(chunk, convert(buffer[idx]));
             }
-            else {
-                break;
+            if (number_of_bytes % sizeof(Raw) != 0) {
+                error_ = "the file size is not a multiple of " + std::to_string(sizeof(Raw)) +
+                         " bytes";
+                return;
             }
         }
-        auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
-        if (r.low() < UINT64_C(1844674407370955162)) {
-            n = r.high();
-            s += 1;
-        }
-        return {n, s};
     }
 
-    remove_trailing_zeros_return<std::uint64_t> lemire_8_2_1(std::uint64_t n) noexcept {
-        {
-            // Is n divisible by 10^8?
-            // 12089258196146292 = ceil(2^90 / 10^8).
-            // Works up to n <= 47'795'296'599'999'999.
-            auto r = wuint::umul128(n, UINT64_C(12089258196146292));
-            if ((r.high() & ((std::uint64_t(1) << (80 - 64)) - 1)) == 0 &&
-                r.low() < UINT64_C(12089258196146292)) {
-                // If yes, work with the quotient.
-                auto result = alg32::lemire_2_1(std::uint32_t(r.high() >> (80 - 64)));
-                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
+    void read_text(std::vector<T>& chunk) {
+        using traits = std::ifstream::traits_type;
+        auto const is_space = [](traits::int_type c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        };
+        auto const buffer = file_.rdbuf();
+        while (chunk.size() < chunk_size_) {
+            auto c = buffer->sgetc();
+            while (is_space(c)) {
+                c = buffer->snextc();
+            }
+            if (c == traits::eof()) {
+                return;
             }
-        }
 
-        std::size_t s = 0;
-        while (true) {
-            auto const r = wuint::umul128(n, UINT64_C(184467440737095517));
-            if (r.low() < UINT64_C(184467440737095517)) {
-                n = r.high();
-                s += 2;
+            T n = 0;
+            bool overflow = false;
+            bool has_digits = false;
+            for (; c >= '0' && c <= '9'; c = buffer->snextc()) {
+                auto const digit = T(c - '0');
+                overflow = overflow || n > (std::numeric_limits<T>::max() - digit) / 10;
+                n = T(n * 10 + digit);
+                has_digits = true;
             }
-            else {
-                break;
+            if (!has_digits || (c != traits::eof() && !is_space(c))) {
+                error_ = "the file contains something other than unsigned decimal integers";
+                return;
             }
+            accept(chunk, overflow ? std::nullopt : std::optional<T>{n});
         }
-        auto const r = wuint::umul128(n, UINT64_C(1844674407370955162));
-        if (r.low() < UINT64_C(1844674407370955162)) {
-            n = r.high();
-            s += 1;
-        }
-        return {n, s};
     }
 
-    remove_trailing_zeros_return<std::uint64_t> lemire_branchless(std::uint64_t n) noexcept {
-        std::size_t s = 0;
+    std::ifstream file_;
+    bool opened_;
+    sample_file_format format_;
+    std::size_t min_digits_;
+    std::size_t max_digits_;
+    T min_value_;
+    T max_value_;
+    std::size_t chunk_size_;
+    std::vector<T> current_chunk_;
+    std::future<std::vector<T>> pending_chunk_;
+    // Only accessed by the thread reading the pending chunk while there is one.
+    std::uint64_t number_of_skipped_samples_ = 0;
+    std::string error_;
+};
 
-        auto r = wuint::umul128(n, UINT64_C(12089258196146292));
-        auto b = (r.high() & ((std::uint64_t(1) << (80 - 64)) - 1)) == 0 &&
-                 r.low() < UINT64_C(12089258196146292);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r.high() >> (80 - 64)) : n;
+// Candidates doing nothing, to measure the overhead of the benchmark loop.
+namespace alg32 {
+    remove_trailing_zeros_return<std::uint32_t> baseline(std::uint32_t n) noexcept { return {n, 0}; }
+}
 
-        r = wuint::umul128(n, UINT64_C(472236648286964522));
-        b = (r.high() & ((std::uint64_t(1) << (72 - 64)) - 1)) == 0 &&
-            r.low() < UINT64_C(472236648286964522);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r.high() >> (72 - 64)) : n;
+namespace alg64 {
+    remove_trailing_zeros_return<std::uint64_t> baseline(std::uint64_t n) noexcept { return {n, 0}; }
+}
 
-        r = wuint::umul128(n, UINT64_C(184467440737095517));
-        b = r.low() < UINT64_C(184467440737095517);
-        s = s * 2 + b;
-        n = b ? r.high() : n;
+#if defined(__SIZEOF_INT128__)
+namespace alg128 {
+    remove_trailing_zeros_return<builtin_uint128_t> baseline(builtin_uint128_t n) noexcept {
+        return {n, 0};
+    }
+}
+#endif
 
-        r = wuint::umul128(n, UINT64_C(1844674407370955162));
-        b = r.low() < UINT64_C(1844674407370955162);
-        s = s * 2 + b;
-        n = b ? r.high() : n;
+struct measurement_statistics {
+    double mean = 0;
+    double median = 0;
+    double min = 0;
+    double p90 = 0;
+    double stddev = 0;
+    // 95% bootstrap confidence interval of the median.
+    double median_lower_bound = 0;
+    double median_upper_bound = 0;
+};
 
-        return {n, s};
-    }
+// Linear interpolation between closest ranks. sorted_values must not be empty.
+double compute_percentile(std::span<double const> sorted_values, double fraction) {
+    auto const position = fraction * double(sorted_values.size() - 1);
+    auto const lower = std::size_t(position);
+    auto const upper = std::min(lower + 1, sorted_values.size() - 1);
+    return sorted_values[lower] +
+           (position - double(lower)) * (sorted_values[upper] - sorted_values[lower]);
+}
 
-    remove_trailing_zeros_return<std::uint64_t>
-    generalized_granlund_montgomery(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
-            if (r < UINT64_C(1844674407370955163)) {
-                n = std::uint64_t(r >> 1);
-                s += 1;
-            }
-            else {
-                break;
-            }
-        }
-        return {n, s};
-    }
+constexpr std::size_t number_of_bootstrap_resamples = 2000;
 
-    remove_trailing_zeros_return<std::uint64_t>
-    generalized_granlund_montgomery_2_1(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint64_t(n * UINT64_C(14941862699704736809));
-            if (r < UINT64_C(184467440737095517)) {
-                n = std::uint64_t(r >> 2);
-                s += 2;
-            }
-            else {
-                break;
-            }
-        }
-        auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
-        if (r < UINT64_C(1844674407370955163)) {
-            n = std::uint64_t(r >> 1);
-            s += 1;
+// Medians of resamples drawn with replacement from values.
+std::vector<double> compute_bootstrap_medians(std::span<double const> values, std::mt19937_64& rg) {
+    std::uniform_int_distribution<std::size_t> index_distribution{0, values.size() - 1};
+    std::vector<double> resample(values.size());
+    std::vector<double> medians(number_of_bootstrap_resamples);
+    for (auto& median : medians) {
+        for (auto& value : resample) {
+            value = values[index_distribution(rg)];
         }
-        return {n, s};
+        std::sort(resample.begin(), resample.end());
+        median = compute_percentile(resample, 0.5);
     }
+    return medians;
+}
 
-    remove_trailing_zeros_return<std::uint64_t>
-    generalized_granlund_montgomery_8_2_1(std::uint64_t n) noexcept {
-        {
-            // Is n divisible by 10^8?
-            auto const r = std::uint64_t(n * UINT64_C(28999941890838049));
-            if (r < UINT64_C(184467440969)) {
-                // If yes, work with the quotient.
-                auto result = alg32::generalized_granlund_montgomery_2_1(std::uint32_t(r >> 8));
-                return {std::uint64_t(result.trimmed_number), result.number_of_removed_zeros + 8};
-            }
-        }
+measurement_statistics compute_statistics(std::vector<double> values, std::mt19937_64& rg) {
+    std::sort(values.begin(), values.end());
 
-        std::size_t s = 0;
-        while (true) {
-            auto const r = std::uint64_t(n * UINT64_C(14941862699704736809));
-            if (r < UINT64_C(184467440737095517)) {
-                n = std::uint64_t(r >> 2);
-                s += 2;
-            }
-            else {
-                break;
-            }
-        }
-        auto const r = std::uint64_t(n * UINT64_C(5534023222112865485));
-        if (r < UINT64_C(1844674407370955163)) {
-            n = std::uint64_t(r >> 1);
-            s += 1;
+    measurement_statistics result;
+    auto const n = double(values.size());
+    for (auto const value : values) {
+        result.mean += value;
+    }
+    result.mean /= n;
+    if (values.size() > 1) {
+        for (auto const value : values) {
+            result.stddev += (value - result.mean) * (value - result.mean);
         }
-        return {n, s};
+        result.stddev = std::sqrt(result.stddev / (n - 1));
     }
+    result.median = compute_percentile(values, 0.5);
+    result.min = values.front();
+    result.p90 = compute_percentile(values, 0.9);
 
-    remove_trailing_zeros_return<std::uint64_t>
-    generalized_granlund_montgomery_branchless(std::uint64_t n) noexcept {
-        std::size_t s = 0;
-
-        auto r = std::uint64_t(n * UINT64_C(28999941890838049));
-        auto b = r < UINT64_C(184467440969);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r >> 8) : n;
-
-        r = std::uint64_t(n * UINT64_C(182622766329724561));
-        b = r < UINT64_C(1844674407370971);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r >> 4) : n;
-
-        r = std::uint64_t(n * UINT64_C(14941862699704736809));
-        b = r < UINT64_C(184467440737095517);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r >> 2) : n;
-
-        r = std::uint64_t(n * UINT64_C(5534023222112865485));
-        b = r < UINT64_C(1844674407370955163);
-        s = s * 2 + b;
-        n = b ? std::uint64_t(r >> 1) : n;
+    auto medians = compute_bootstrap_medians(values, rg);
+    std::sort(medians.begin(), medians.end());
+    result.median_lower_bound = compute_percentile(medians, 0.025);
+    result.median_upper_bound = compute_percentile(medians, 0.975);
+    return result;
+}
 
-        return {n, s};
+// Checks whether the 95% bootstrap confidence interval of the difference of the medians contains
+// zero.
+bool are_statistically_indistinguishable(std::span<double const> x, std::span<double const> y,
+                                         std::mt19937_64& rg) {
+    auto const x_medians = compute_bootstrap_medians(x, rg);
+    auto const y_medians = compute_bootstrap_medians(y, rg);
+    std::vector<double> differences(number_of_bootstrap_resamples);
+    for (std::size_t idx = 0; idx < number_of_bootstrap_resamples; ++idx) {
+        differences[idx] = x_medians[idx] - y_medians[idx];
     }
-
-    remove_trailing_zeros_return<std::uint64_t> baseline(std::uint64_t n) noexcept { return {n, 0}; }
+    std::sort(differences.begin(), differences.end());
+    return compute_percentile(differences, 0.025) <= 0 && compute_percentile(differences, 0.975) >= 0;
 }
 
-template <class T>
-struct benchmark_candidate {
-    std::string name;
-    remove_trailing_zeros_return<T> (*candidate_function)(T);
-    double average_time_in_nanoseconds = 0;
+// Hardware event counts per sample.
+struct hardware_counter_values {
+    double cycles = 0;
+    double instructions = 0;
+    double branches = 0;
+    double branch_misses = 0;
 };
 
-template <class T>
-void benchmark(std::vector<benchmark_candidate<T>>& benchmark_candidates, std::size_t number_of_samples,
-               std::size_t max_digits, std::chrono::milliseconds min_duration_per_alg) {
-
-    std::cout << "Generating samples...\n";
-    auto const samples = generate_random_samples<T>(number_of_samples, max_digits);
+hardware_counter_values average(std::span<hardware_counter_values const> values) {
+    hardware_counter_values result;
+    for (auto const& value : values) {
+        result.cycles += value.cycles;
+        result.instructions += value.instructions;
+        result.branches += value.branches;
+        result.branch_misses += value.branch_misses;
+    }
+    auto const n = double(values.size());
+    result.cycles /= n;
+    result.instructions /= n;
+    result.branches /= n;
+    result.branch_misses /= n;
+    return result;
+}
 
-    std::cout << "Verifying candaite algorithms...\n";
-    for (auto const& sample : samples) {
-        auto itr = benchmark_candidates.cbegin() + 1;
-        auto const reference_result = (*itr->candidate_function)(sample);
-        for (++itr; itr != benchmark_candidates.cend(); ++itr) {
-            if ((*itr->candidate_function)(sample) != reference_result) {
+// User-space cycles, instructions, branches and branch misses of the calling thread, counted
+// together as one perf_event group so that all of them cover exactly the same code. The counters
+// are read once per timed region, so the cost of read(2) compared to rdpmc does not matter.
+class perf_counter_group {
+public:
+    perf_counter_group() {
+#if defined(__linux__)
+        constexpr std::uint64_t configs[number_of_events] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (std::size_t idx = 0; idx < number_of_events; ++idx) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[idx];
+            // Only the leader is disabled; the others follow it.
+            attr.disabled = idx == 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format =
+                PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            auto const fd = int(syscall(SYS_perf_event_open, &attr, 0, -1,
+                                        idx == 0 ? -1 : file_descriptors_[0], 0));
+            if (fd == -1) {
+                error_ = std::string{"perf_event_open failed: "} + std::strerror(errno);
+                close_all();
+                return;
+            }
+            file_descriptors_[idx] = fd;
+        }
+#else
+        error_ = "not supported on this platform";
+#endif
+    }
+    perf_counter_group(perf_counter_group const&) = delete;
+    perf_counter_group& operator=(perf_counter_group const&) = delete;
+    ~perf_counter_group() { close_all(); }
+
+    bool available() const noexcept { return file_descriptors_[0] != -1; }
+    // Why the counters are unavailable.
+    std::string const& error() const noexcept { return error_; }
+
+    void start() noexcept {
+#if defined(__linux__)
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Returns the counts since start() divided by number_of_samples, scaled up if the kernel
+    // had to multiplex the group with other events. All zero if the group was never scheduled.
+    hardware_counter_values stop(double number_of_samples) noexcept {
+        hardware_counter_values result;
+#if defined(__linux__)
+        ioctl(file_descriptors_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // Number of events, time enabled, time running, then the counts in order of creation.
+        std::uint64_t buffer[3 + number_of_events] = {};
+        if (read(file_descriptors_[0], buffer, sizeof(buffer)) != ssize_t(sizeof(buffer)) ||
+            buffer[2] == 0) {
+            return result;
+        }
+        auto const scale = double(buffer[1]) / double(buffer[2]) / number_of_samples;
+        result.cycles = double(buffer[3]) * scale;
+        result.instructions = double(buffer[4]) * scale;
+        result.branches = double(buffer[5]) * scale;
+        result.branch_misses = double(buffer[6]) * scale;
+#else
+        static_cast<void>(number_of_samples);
+#endif
+        return result;
+    }
+
+private:
+    static constexpr std::size_t number_of_events = 4;
+
+    void close_all() noexcept {
+        for (auto& fd : file_descriptors_) {
+#if defined(__linux__)
+            if (fd != -1) {
+                close(fd);
+            }
+#endif
+            fd = -1;
+        }
+    }
+
+    int file_descriptors_[number_of_events] = {-1, -1, -1, -1};
+    std::string error_;
+};
+
+enum class timer_source {
+    // The time-stamp counter on x86 if it is invariant, the virtual counter on AArch64.
+    counter,
+    steady_clock
+};
+
+// Timestamps of the measurements. The counters cost a few dozen cycles per read instead of a
+// call into the vDSO, and are fenced so that the timed code can neither start before the first
+// read nor finish after the second. Their ticks are converted to nanoseconds with the frequency
+// measured against std::chrono::steady_clock; on x86 they are reference cycles at the nominal
+// frequency of the CPU, not the core cycles --perf-counters counts.
+class interval_timer {
+public:
+    // Falls back to steady_clock if the counter is unavailable.
+    static interval_timer calibrate(timer_source source) {
+        interval_timer timer;
+        if (source == timer_source::counter && counter_available()) {
+            timer.source_ = timer_source::counter;
+            // Long enough for the resolution of steady_clock not to matter.
+            constexpr auto calibration_duration = std::chrono::milliseconds{50};
+            auto const start_time = std::chrono::steady_clock::now();
+            auto const start_ticks = timer.start();
+            auto duration = std::chrono::steady_clock::now() - start_time;
+            while (duration < calibration_duration) {
+                duration = std::chrono::steady_clock::now() - start_time;
+            }
+            auto const ticks = timer.stop() - start_ticks;
+            timer.ticks_per_nanosecond_ =
+                double(ticks) / std::chrono::duration<double, std::nano>{duration}.count();
+        }
+
+        // Back-to-back reads; the minimum is what the fences and the reads themselves cost.
+        timer.overhead_ticks_ = std::numeric_limits<std::uint64_t>::max();
+        for (int idx = 0; idx < 1000; ++idx) {
+            auto const start_ticks = timer.start();
+            timer.overhead_ticks_ = std::min(timer.overhead_ticks_, timer.stop() - start_ticks);
+        }
+        return timer;
+    }
+
+    timer_source source() const noexcept { return source_; }
+
+    std::string_view name() const noexcept {
+        if (source_ == timer_source::steady_clock) {
+            return "steady_clock";
+        }
+#if defined(__aarch64__) || defined(_M_ARM64)
+        return "cntvct_el0";
+#else
+        return "rdtscp";
+#endif
+    }
+
+    // Unit of the ticks if they are worth reporting next to nanoseconds, otherwise empty. Not
+    // "cycles" even on x86, where the counter runs at the nominal rather than the core frequency.
+    std::string_view tick_unit() const noexcept {
+        if (source_ == timer_source::steady_clock) {
+            return {};
+        }
+        return "ticks";
+    }
+
+    // Call before the timed code.
+    std::uint64_t start() const noexcept {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        auto const ticks = source_ == timer_source::counter ? read_counter(false) : read_clock();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        return ticks;
+    }
+
+    // Call after the timed code.
+    std::uint64_t stop() const noexcept {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        auto const ticks = source_ == timer_source::counter ? read_counter(true) : read_clock();
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        return ticks;
+    }
+
+    double ticks_per_nanosecond() const noexcept { return ticks_per_nanosecond_; }
+    // Of a start() immediately followed by a stop().
+    std::uint64_t overhead_ticks() const noexcept { return overhead_ticks_; }
+
+    double to_nanoseconds(std::uint64_t ticks) const noexcept {
+        return double(ticks) / ticks_per_nanosecond_;
+    }
+    std::uint64_t to_ticks(std::chrono::nanoseconds duration) const noexcept {
+        return std::uint64_t(double(duration.count()) * ticks_per_nanosecond_);
+    }
+
+private:
+    static bool counter_available() noexcept {
+#if defined(RTZ_BENCHMARK_TIMESTAMP_COUNTER) && defined(__GNUC__)
+        // rdtscp raises #UD on CPUs, or under hypervisors, that do not report it. Without an
+        // invariant TSC, the frequency changes with the core clock.
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) == 0 || (edx & (1u << 27)) == 0) {
+            return false;
+        }
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) != 0 && (edx & (1u << 8)) != 0;
+#elif defined(RTZ_BENCHMARK_TIMESTAMP_COUNTER)
+        int info[4] = {};
+        __cpuid(info, 0x80000000);
+        if (unsigned(info[0]) < 0x80000007) {
+            return false;
+        }
+        __cpuid(info, 0x80000001);
+        if ((info[3] & (1 << 27)) == 0) {
+            return false;
+        }
+        __cpuid(info, 0x80000007);
+        return (info[3] & (1 << 8)) != 0;
+#elif defined(__GNUC__) && defined(__aarch64__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // rdtscp waits for the preceding instructions to execute, and the lfence after it keeps the
+    // following ones from starting before. For the first read, an lfence before rdtsc does
+    // what rdtscp does.
+    static std::uint64_t read_counter([[maybe_unused]] bool after_timed_code) noexcept {
+#if defined(RTZ_BENCHMARK_TIMESTAMP_COUNTER)
+        std::uint64_t ticks;
+        if (after_timed_code) {
+            unsigned int aux;
+            ticks = __rdtscp(&aux);
+        }
+        else {
+            _mm_lfence();
+            ticks = __rdtsc();
+        }
+        _mm_lfence();
+        return ticks;
+#elif defined(__GNUC__) && defined(__aarch64__)
+        // isb completes the preceding instructions before the counter is read.
+        std::uint64_t ticks;
+        asm volatile("isb\n\tmrs %0, cntvct_el0\n\tisb" : "=r"(ticks) : : "memory");
+        return ticks;
+#else
+        return read_clock();
+#endif
+    }
+
+    static std::uint64_t read_clock() noexcept {
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count());
+    }
+
+    timer_source source_ = timer_source::steady_clock;
+    double ticks_per_nanosecond_ = 1;
+    std::uint64_t overhead_ticks_ = 0;
+};
+
+// Calibrated by main before anything is measured.
+interval_timer benchmark_timer;
+
+struct multithreaded_measurement {
+    // Samples per nanosecond summed over all threads.
+    double aggregate_samples_per_nanosecond = 0;
+    // Average time per sample seen by each thread, in the order of the CPUs.
+    std::vector<double> nanoseconds_per_thread;
+    // Whether all threads could be pinned to their CPUs.
+    bool pinned = true;
+};
+
+// The largest input with the number of digits every kernel of remove_trailing_zeros.hpp of the
+// width supports unless noted otherwise: 8 for alg32, 16 for alg64 and 34 for alg128.
+template <class T>
+constexpr T default_max_input =
+    T(compute_power(T{10}, sizeof(T) <= 4 ? 8 : sizeof(T) <= 8 ? 16 : 34) - 1);
+
+template <class T>
+struct benchmark_candidate {
+    std::string name;
+    remove_trailing_zeros_return<T> (*candidate_function)(T) = nullptr;
+    // Set instead of candidate_function for candidates processing all samples at once.
+    void (*batch_candidate_function)(std::span<T const>, std::span<T>,
+                                     std::span<std::size_t>) = nullptr;
+    // Loop over all samples with candidate_function inlined into it.
+    void (*inlined_loop)(std::span<T const>) = nullptr;
+    // Same as inlined_loop, but every input depends on the previous result.
+    void (*inlined_dependent_loop)(std::span<T const>, T) = nullptr;
+    // Trimming and printing with candidate_function inlined; not set for 128-bit candidates.
+    void (*inlined_pipeline_loop)(std::span<pipeline_sample<T> const>, char*) = nullptr;
+    // Average time per sample in nanoseconds, one entry for each repetition.
+    std::vector<double> throughput_measurements{};
+    // Not measured for batch candidates.
+    std::vector<double> latency_measurements{};
+    measurement_statistics throughput_statistics{};
+    measurement_statistics latency_statistics{};
+    // Averaged over repetitions; only set if hardware counters were requested and available.
+    std::optional<hardware_counter_values> throughput_counters{};
+    std::optional<hardware_counter_values> latency_counters{};
+    // Only set if CPUs for the multi-threaded measurement were given.
+    std::optional<multithreaded_measurement> multithreaded_throughput{};
+    // Throughput with the L1 data cache evicted regularly; only measured if requested.
+    std::vector<double> l1_cold_measurements{};
+    measurement_statistics l1_cold_statistics{};
+    // Latency of single calls after disturbing the caches and predictors, one entry per call;
+    // only measured if requested.
+    std::vector<double> cold_call_measurements{};
+    measurement_statistics cold_call_statistics{};
+    // Time per number of the float-to-string pipeline; only measured by --pipeline.
+    std::vector<double> pipeline_measurements{};
+    measurement_statistics pipeline_statistics{};
+    // Unselected candidates are neither verified nor benchmarked.
+    bool selected = true;
+    // Inputs above it are outside of the domain of the candidate, where it may not even terminate,
+    // and are not verified.
+    T max_input = default_max_input<T>;
+};
+
+enum class dispatch_mode {
+    // Each candidate is timed through its own loop, with the candidate function inlined.
+    inlined,
+    // Each sample goes through an indirect call to the candidate function, which costs
+    // roughly what the "Null (baseline)" candidate measures.
+    function_pointer
+};
+
+enum class schedule_mode {
+    // All measurements of a candidate are taken before moving on to the next one.
+    sequential,
+    // One measurement of every candidate per round, in an order shuffled every round.
+    interleaved
+};
+
+enum class measurement_mode {
+    // Samples are independent of each other, so the CPU is free to overlap consecutive calls.
+    throughput,
+    // Each input depends on the previous result, like when Dragonbox feeds the trimmed
+    // significand directly into digit generation.
+    latency,
+    both
+};
+
+template <class T>
+T sample_type_of(remove_trailing_zeros_return<T> (*)(T));
+template <class T>
+T sample_type_of(void (*)(std::span<T const>, std::span<T>, std::span<std::size_t>));
+
+// Writing the members one by one avoids the reload GCC emits when copying the whole struct into
+// a volatile object, which otherwise dominates the cost of cheap candidates.
+template <class T>
+void consume_result(remove_trailing_zeros_return<T> const& result) noexcept {
+    [[maybe_unused]] T volatile trimmed_number = result.trimmed_number;
+    [[maybe_unused]] std::size_t volatile number_of_removed_zeros = result.number_of_removed_zeros;
+}
+
+// GCC's -fsplit-paths, enabled by -O3, copies the end of the loop body into both arms of the
+// final select of an inlined branchless kernel, which turns that select into a branch. An empty
+// asm statement on the result does not prevent it, since the copied block still uses the result.
+#if defined(__GNUC__) && !defined(__clang__)
+    #define RTZ_BENCHMARK_NO_SPLIT_PATHS __attribute__((optimize("no-split-paths")))
+#else
+    #define RTZ_BENCHMARK_NO_SPLIT_PATHS
+#endif
+
+template <auto candidate_function, class T>
+RTZ_BENCHMARK_NO_SPLIT_PATHS void run_inlined_loop(std::span<T const> samples) {
+    for (auto const& sample : samples) {
+        consume_result(candidate_function(sample));
+    }
+}
+
+// The dependency is derived from the previous result masked by zero, which is not known to be
+// zero at compile time, so the inputs are unchanged but still cannot be fed before the previous
+// call finishes.
+template <class T, class CandidateFunction>
+void run_dependent_loop(CandidateFunction&& candidate_function, std::span<T const> samples, T zero) {
+    auto result = remove_trailing_zeros_return<T>{0, 0};
+    for (auto const& sample : samples) {
+        auto const dependency = T((result.trimmed_number + result.number_of_removed_zeros) & zero);
+        result = candidate_function(T(sample | dependency));
+    }
+    consume_result(result);
+}
+
+template <auto candidate_function, class T>
+void run_inlined_dependent_loop(std::span<T const> samples, T zero) {
+    run_dependent_loop(candidate_function, samples, zero);
+}
+
+constexpr auto radix_100_table = [] {
+    std::array<char, 200> table{};
+    for (std::size_t idx = 0; idx < 100; ++idx) {
+        table[2 * idx] = char('0' + idx / 10);
+        table[2 * idx + 1] = char('0' + idx % 10);
+    }
+    return table;
+}();
+
+// Longest output of write_scientific, for 64-bit significands.
+constexpr std::size_t max_scientific_length = 32;
+
+// Writes significand * 10^exponent as [-]d[.ddd]e[-]d[d[d]], two digits at a time like
+// formatting libraries do, and returns the end. Reads back with std::from_chars.
+template <class T>
+char* write_scientific(bool negative, T significand, int exponent, char* buffer) noexcept {
+    if (negative) {
+        *buffer++ = '-';
+    }
+    constexpr auto max_digits = std::size_t(std::numeric_limits<T>::digits10) + 1;
+    std::size_t number_of_digits = 1;
+    for (T power = 10; number_of_digits < max_digits && significand >= power; power *= 10) {
+        ++number_of_digits;
+    }
+
+    // The digits go one position to the right, and the leading one is then moved in front of the
+    // decimal point.
+    auto ptr = buffer + number_of_digits + 1;
+    auto n = significand;
+    while (n >= 100) {
+        ptr -= 2;
+        std::memcpy(ptr, &radix_100_table[std::size_t(n % 100) * 2], 2);
+        n /= 100;
+    }
+    if (n >= 10) {
+        ptr -= 2;
+        std::memcpy(ptr, &radix_100_table[std::size_t(n) * 2], 2);
+    }
+    else {
+        *--ptr = char('0' + int(n));
+    }
+    buffer[0] = buffer[1];
+    auto end = buffer + 1;
+    if (number_of_digits > 1) {
+        buffer[1] = '.';
+        end = buffer + number_of_digits + 1;
+    }
+
+    *end++ = 'e';
+    auto const scientific_exponent = exponent + int(number_of_digits) - 1;
+    if (scientific_exponent < 0) {
+        *end++ = '-';
+    }
+    auto e = std::size_t(scientific_exponent < 0 ? -scientific_exponent : scientific_exponent);
+    if (e >= 100) {
+        *end++ = char('0' + e / 100);
+        e %= 100;
+        std::memcpy(end, &radix_100_table[e * 2], 2);
+        end += 2;
+    }
+    else if (e >= 10) {
+        std::memcpy(end, &radix_100_table[e * 2], 2);
+        end += 2;
+    }
+    else {
+        *end++ = char('0' + e);
+    }
+    return end;
+}
+
+// The stages of float-to-string conversion after digit generation: trailing zero removal, then
+// printing into output, which needs room for max_scientific_length characters per sample.
+template <class T, class CandidateFunction>
+void run_pipeline_loop(CandidateFunction&& candidate_function,
+                       std::span<pipeline_sample<T> const> samples, char* output) {
+    for (auto const& sample : samples) {
+        auto const result = candidate_function(sample.significand);
+        output = write_scientific(sample.negative, result.trimmed_number,
+                                  sample.exponent + int(result.number_of_removed_zeros), output);
+    }
+}
+
+template <auto candidate_function, class T>
+void run_inlined_pipeline_loop(std::span<pipeline_sample<T> const> samples, char* output) {
+    run_pipeline_loop(candidate_function, samples, output);
+}
+
+// Runs run_once repeatedly until min_duration elapses. If counters is given, the hardware event
+// counts per sample over the same runs are stored into counter_values.
+template <class Function>
+double measure_average_time_in_nanoseconds(Function&& run_once, std::size_t number_of_samples,
+                                           std::chrono::milliseconds min_duration,
+                                           perf_counter_group* counters = nullptr,
+                                           hardware_counter_values* counter_values = nullptr) {
+    auto const min_ticks = benchmark_timer.to_ticks(min_duration);
+    if (counters != nullptr) {
+        counters->start();
+    }
+    auto const start_ticks = benchmark_timer.start();
+    std::size_t run_count = 0;
+    while (true) {
+        run_once();
+        auto const ticks = benchmark_timer.stop() - start_ticks;
+        ++run_count;
+
+        if (ticks >= min_ticks) {
+            auto const total_number_of_samples = double(run_count) * number_of_samples;
+            if (counters != nullptr) {
+                *counter_values = counters->stop(total_number_of_samples);
+            }
+            return benchmark_timer.to_nanoseconds(ticks) / total_number_of_samples;
+        }
+    }
+}
+
+// One pass over all samples, as timed for throughput. The output buffers are only used by batch
+// candidates.
+template <class T>
+void run_throughput_pass(benchmark_candidate<T> const& candidate, dispatch_mode mode,
+                         std::span<T const> samples, std::span<T> trimmed_numbers,
+                         std::span<std::size_t> numbers_of_removed_zeros) {
+    if (candidate.batch_candidate_function != nullptr) {
+        (*candidate.batch_candidate_function)(samples, trimmed_numbers, numbers_of_removed_zeros);
+    }
+    else if (mode == dispatch_mode::inlined) {
+        (*candidate.inlined_loop)(samples);
+    }
+    else {
+        for (auto const& sample : samples) {
+            consume_result((*candidate.candidate_function)(sample));
+        }
+    }
+}
+
+// Falls back to 48KB if the size cannot be queried.
+std::size_t l1_data_cache_size() {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    if (auto const size = sysconf(_SC_LEVEL1_DCACHE_SIZE); size > 0) {
+        return std::size_t(size);
+    }
+#endif
+    return 48 * 1024;
+}
+
+// Reads one byte of every cache line of buffer, which replaces the contents of the L1 data cache
+// if the buffer is large enough.
+void evict_data_cache(std::span<std::byte const> buffer) {
+    constexpr std::size_t cache_line_size = 64;
+    std::byte sum{};
+    for (std::size_t idx = 0; idx < buffer.size(); idx += cache_line_size) {
+        sum ^= buffer[idx];
+    }
+    [[maybe_unused]] std::byte volatile result = sum;
+}
+
+// Same as measuring run_throughput_pass, except that the samples are processed in blocks of
+// block_size samples with the L1 data cache evicted before each block, and only the blocks are
+// timed. The clock is read twice per block, which the baseline measures as well.
+template <class T>
+double measure_l1_cold_time_in_nanoseconds(benchmark_candidate<T> const& candidate,
+                                           dispatch_mode mode, std::span<T const> samples,
+                                           std::span<T> trimmed_numbers,
+                                           std::span<std::size_t> numbers_of_removed_zeros,
+                                           std::span<std::byte const> eviction_buffer,
+                                           std::size_t block_size,
+                                           std::chrono::milliseconds min_duration) {
+    auto const min_ticks = benchmark_timer.to_ticks(min_duration);
+    auto const start_ticks = benchmark_timer.start();
+    std::uint64_t timed_ticks = 0;
+    std::size_t run_count = 0;
+    while (true) {
+        for (std::size_t first = 0; first < samples.size(); first += block_size) {
+            auto const count = std::min(block_size, samples.size() - first);
+            evict_data_cache(eviction_buffer);
+            auto const block_start_ticks = benchmark_timer.start();
+            run_throughput_pass(candidate, mode, samples.subspan(first, count),
+                                trimmed_numbers.subspan(first, count),
+                                numbers_of_removed_zeros.subspan(first, count));
+            timed_ticks += benchmark_timer.stop() - block_start_ticks;
+        }
+        ++run_count;
+
+        if (benchmark_timer.stop() - start_ticks >= min_ticks) {
+            return benchmark_timer.to_nanoseconds(timed_ticks) /
+                   (double(run_count) * double(samples.size()));
+        }
+    }
+}
+
+// What the cold-call measurement disturbs before every call.
+struct cold_call_config {
+    // Bytes of data read before each call; 0 leaves the data caches alone.
+    std::size_t data_bytes = 0;
+    // Run through more code than fits in the L1 instruction cache.
+    bool instructions = false;
+    // Run branches with random outcomes at many sites.
+    bool branches = false;
+    // Iterations of a filler workload standing in for the rest of a formatter.
+    std::size_t filler_iterations = 0;
+
+    bool enabled() const noexcept {
+        return data_bytes != 0 || instructions || branches || filler_iterations != 0;
+    }
+};
+
+std::string describe(cold_call_config const& config) {
+    std::string result;
+    auto const append = [&](std::string const& item) {
+        result += (result.empty() ? "" : ", ") + item;
+    };
+    if (config.data_bytes != 0) {
+        append("data " + std::to_string(config.data_bytes / 1024) + "KB");
+    }
+    if (config.instructions) {
+        append("instructions");
+    }
+    if (config.branches) {
+        append("branches");
+    }
+    if (config.filler_iterations != 0) {
+        append("filler " + std::to_string(config.filler_iterations));
+    }
+    return result;
+}
+
+// Falls back to 1MB if the size cannot be queried.
+std::size_t l2_cache_size() {
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    if (auto const size = sysconf(_SC_LEVEL2_CACHE_SIZE); size > 0) {
+        return std::size_t(size);
+    }
+#endif
+    return 1024 * 1024;
+}
+
+// Distinct functions to run through the instruction cache. The constants differ for each of them,
+// so that the linker cannot fold them together, and each has a few data-dependent branches.
+template <std::size_t idx>
+std::uint64_t instruction_filler(std::uint64_t x) noexcept {
+    constexpr auto multiplier = UINT64_C(0x9e3779b97f4a7c15) * (2 * idx + 1);
+    for (int round = 0; round < 4; ++round) {
+        x ^= x >> 29;
+        x *= multiplier;
+        if ((x & (std::uint64_t(1) << (idx % 64))) != 0) {
+            x += multiplier >> (round + 1);
+        }
+        else {
+            x ^= multiplier << round;
+        }
+    }
+    return x;
+}
+
+template <std::size_t... indices>
+constexpr auto make_instruction_filler_table(std::index_sequence<indices...>) noexcept {
+    return std::array<std::uint64_t (*)(std::uint64_t) noexcept, sizeof...(indices)>{
+        &instruction_filler<indices>...};
+}
+
+// Around 100KB of code with GCC or Clang on x86-64, several times the size of the L1 instruction
+// cache.
+inline constexpr auto instruction_fillers =
+    make_instruction_filler_table(std::make_index_sequence<1024>{});
+
+// Applies the disturbances of a cold_call_config.
+class cold_call_disturbance {
+public:
+    explicit cold_call_disturbance(cold_call_config const& config)
+        : config_{config}, data_buffer_(config.data_bytes, std::byte{1}),
+          random_bytes_(config.branches ? 16384 : 0), filler_table_(4096) {
+        std::mt19937_64 rg;
+        for (auto& byte : random_bytes_) {
+            byte = std::uint8_t(rg());
+        }
+        for (auto& entry : filler_table_) {
+            entry = rg();
+        }
+    }
+
+    void operator()() {
+        if (!data_buffer_.empty()) {
+            evict_data_cache(data_buffer_);
+        }
+        auto state = state_;
+        if (config_.instructions) {
+            for (auto const filler : instruction_fillers) {
+                state = filler(state);
+            }
+        }
+        if (config_.branches) {
+            // Stores to volatile objects cannot be made unconditional, so these stay branches.
+            for (auto const byte : random_bytes_) {
+                if ((byte & 1) != 0) {
+                    branch_sink_[0] = byte;
+                }
+                if ((byte & 2) != 0) {
+                    branch_sink_[1] = byte;
+                }
+                if ((byte & 4) != 0) {
+                    branch_sink_[2] = byte;
+                }
+                if ((byte & 8) != 0) {
+                    branch_sink_[3] = byte;
+                }
+            }
+        }
+        // A chain of dependent multiplications and loads from a 32KB table.
+        for (std::size_t iteration = 0; iteration < config_.filler_iterations; ++iteration) {
+            state = state * UINT64_C(6364136223846793005) + filler_table_[state >> 52];
+        }
+        state_ = state;
+    }
+
+private:
+    cold_call_config config_;
+    std::vector<std::byte> data_buffer_;
+    std::vector<std::uint8_t> random_bytes_;
+    std::vector<std::uint64_t> filler_table_;
+    std::uint8_t volatile branch_sink_[4] = {};
+    std::uint64_t volatile state_ = 1;
+};
+
+// Number of calls timed per candidate and repetition in the cold-call measurement.
+constexpr std::size_t number_of_cold_calls = 2000;
+
+// Times single calls on the first samples, each after disturbing the caches and predictors.
+// Batch candidates are called with a single sample. The clock overhead is measured by the
+// baseline as well.
+template <class T>
+void measure_cold_calls_in_nanoseconds(benchmark_candidate<T> const& candidate,
+                                       std::span<T const> samples,
+                                       cold_call_disturbance& disturb, std::vector<double>& durations) {
+    T trimmed_number = 0;
+    std::size_t number_of_removed_zeros = 0;
+    for (std::size_t idx = 0; idx < std::min(number_of_cold_calls, samples.size()); ++idx) {
+        auto const sample = samples[idx];
+        disturb();
+        auto const start_ticks = benchmark_timer.start();
+        if (candidate.batch_candidate_function != nullptr) {
+            (*candidate.batch_candidate_function)(std::span<T const>{&sample, 1},
+                                                  std::span<T>{&trimmed_number, 1},
+                                                  std::span<std::size_t>{&number_of_removed_zeros, 1});
+        }
+        else {
+            consume_result((*candidate.candidate_function)(sample));
+        }
+        durations.push_back(benchmark_timer.to_nanoseconds(benchmark_timer.stop() - start_ticks));
+    }
+}
+
+// Returns false if the calling thread could not be pinned.
+bool pin_current_thread(std::size_t cpu) {
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+// SMT siblings of cpu (including itself) as listed by the kernel, or an empty string if unknown.
+std::string read_smt_siblings(std::size_t cpu) {
+    std::string siblings;
+#if defined(__linux__)
+    std::ifstream file{"/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                       "/topology/thread_siblings_list"};
+    std::getline(file, siblings);
+#else
+    static_cast<void>(cpu);
+#endif
+    return siblings;
+}
+
+// Runs process_chunk(chunk_idx, thread_idx) for every chunk on one thread for each entry of
+// cpus, pinned to that CPU, or on std::thread::hardware_concurrency() unpinned threads if cpus is
+// empty. Threads pick up the next unprocessed chunk until none is left.
+template <class Function>
+void for_each_chunk_in_parallel(std::size_t number_of_chunks, std::span<std::size_t const> cpus,
+                                Function const& process_chunk) {
+    auto const number_of_threads =
+        cpus.empty() ? std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1))
+                     : cpus.size();
+    std::atomic<std::size_t> next_chunk = 0;
+    std::vector<std::thread> threads;
+    for (std::size_t thread_idx = 0; thread_idx < number_of_threads; ++thread_idx) {
+        threads.emplace_back([&, thread_idx] {
+            if (!cpus.empty()) {
+                pin_current_thread(cpus[thread_idx]);
+            }
+            while (true) {
+                auto const chunk_idx = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                if (chunk_idx >= number_of_chunks) {
+                    break;
+                }
+                process_chunk(chunk_idx, thread_idx);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Number of samples generated from each stream by generate_random_samples.
+constexpr std::size_t sample_block_size = std::size_t(1) << 16;
+
+// Generates the samples on all cores. Every block of sample_block_size samples comes from its own
+// stream, so that the samples only depend on the seed, not on the number of threads.
+template <class T>
+std::vector<T> generate_random_samples(std::size_t number_of_samples, std::size_t min_digits,
+                                       std::size_t max_digits, sample_distribution const& distribution,
+                                       std::uint64_t seed) {
+    std::vector<T> samples(number_of_samples);
+    for_each_chunk_in_parallel(
+        (number_of_samples + sample_block_size - 1) / sample_block_size, {},
+        [&](std::size_t block_idx, std::size_t) {
+            xoshiro256_plus_plus rg{seed, block_idx};
+            auto const first = block_idx * sample_block_size;
+            generate_random_samples(
+                std::span<T>{samples}.subspan(first,
+                                              std::min(sample_block_size, number_of_samples - first)),
+                min_digits, max_digits, distribution, rg);
+        });
+    return samples;
+}
+
+// Runs run_once(thread_idx) concurrently on one thread for each entry of cpus, pinned to that CPU,
+// until min_duration elapses. All threads start together, and each one times its own runs.
+template <class Function>
+multithreaded_measurement measure_multithreaded_throughput(Function const& run_once,
+                                                           std::span<std::size_t const> cpus,
+                                                           std::size_t number_of_samples,
+                                                           std::chrono::milliseconds min_duration) {
+    multithreaded_measurement result;
+    result.nanoseconds_per_thread.resize(cpus.size());
+    std::vector<char> pinned(cpus.size());
+    std::atomic<bool> stop = false;
+    std::barrier start_barrier{std::ptrdiff_t(cpus.size() + 1)};
+
+    std::vector<std::thread> threads;
+    for (std::size_t thread_idx = 0; thread_idx < cpus.size(); ++thread_idx) {
+        threads.emplace_back([&, thread_idx] {
+            pinned[thread_idx] = pin_current_thread(cpus[thread_idx]);
+            start_barrier.arrive_and_wait();
+
+            auto const start_ticks = benchmark_timer.start();
+            std::size_t run_count = 0;
+            do {
+                run_once(thread_idx);
+                ++run_count;
+            } while (!stop.load(std::memory_order_relaxed));
+            auto const ticks = benchmark_timer.stop() - start_ticks;
+
+            result.nanoseconds_per_thread[thread_idx] =
+                benchmark_timer.to_nanoseconds(ticks) / (double(run_count) * number_of_samples);
+        });
+    }
+    start_barrier.arrive_and_wait();
+    std::this_thread::sleep_for(min_duration);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t thread_idx = 0; thread_idx < cpus.size(); ++thread_idx) {
+        result.aggregate_samples_per_nanosecond += 1 / result.nanoseconds_per_thread[thread_idx];
+        result.pinned = result.pinned && pinned[thread_idx];
+    }
+    return result;
+}
+
+template <auto candidate_function, class sample_type = decltype(sample_type_of(candidate_function))>
+auto make_candidate(std::string name,
+                    std::type_identity_t<sample_type> max_input = default_max_input<sample_type>) {
+    void (*inlined_pipeline_loop)(std::span<pipeline_sample<sample_type> const>, char*) = nullptr;
+    if constexpr (sizeof(sample_type) <= sizeof(std::uint64_t)) {
+        inlined_pipeline_loop = run_inlined_pipeline_loop<candidate_function, sample_type>;
+    }
+    benchmark_candidate<sample_type> candidate{
+        std::move(name), candidate_function, nullptr,
+        run_inlined_loop<candidate_function, sample_type>,
+        run_inlined_dependent_loop<candidate_function, sample_type>, inlined_pipeline_loop};
+    candidate.max_input = max_input;
+    return candidate;
+}
+
+template <auto batch_candidate_function>
+auto make_batch_candidate(std::string name) {
+    using sample_type = decltype(sample_type_of(batch_candidate_function));
+    return benchmark_candidate<sample_type>{std::move(name), nullptr, batch_candidate_function};
+}
+
+struct benchmark_config {
+    std::size_t number_of_samples = 100000;
+    std::size_t min_digits = 1;
+    std::size_t max_digits = 0;
+    sample_distribution distribution;
+    std::chrono::milliseconds min_duration_per_alg{1500};
+    std::size_t repetitions = 1;
+    // If set, measurements are repeated beyond repetitions until the 95% CI of every median is
+    // within this fraction of it, with each measurement lasting min_duration_per_alg, or until
+    // max_duration_per_alg elapses.
+    std::optional<double> target_relative_ci;
+    std::chrono::milliseconds max_duration_per_alg{10000};
+    // Measurements run and discarded before the repetitions of each candidate.
+    std::size_t warmup_runs = 0;
+    schedule_mode schedule = schedule_mode::sequential;
+    // Seeded from std::random_device if not given.
+    std::optional<std::uint64_t> seed;
+    dispatch_mode dispatch = dispatch_mode::inlined;
+    measurement_mode measurement = measurement_mode::both;
+    // Count cycles, instructions, branches and branch misses during the measurements.
+    bool hardware_counters = false;
+    // Also report the medians net of the baseline, which is then measured even if filtered out.
+    bool subtract_baseline = true;
+    // If not empty, throughput is also measured with one thread pinned to each of these CPUs.
+    std::vector<std::size_t> cpus;
+    // If nonzero, throughput is also measured with the L1 data cache evicted before every block
+    // of this many samples.
+    std::size_t l1_cold_block_size = 0;
+    // If enabled, single calls are also timed after the configured disturbances.
+    cold_call_config cold_calls;
+    // If not empty, samples are streamed from this file instead of being generated, in chunks of
+    // number_of_samples.
+    std::string input_path;
+    sample_file_format input_format = sample_file_format::text;
+};
+
+// The bootstrap CI of fewer measurements is too unreliable to stop on.
+constexpr std::size_t min_adaptive_repetitions = 5;
+
+// Half the width of the 95% CI of the median, relative to the median. A zero median only counts
+// as converged if its CI is empty as well.
+double relative_ci_half_width(measurement_statistics const& statistics) {
+    auto const half_width = (statistics.median_upper_bound - statistics.median_lower_bound) / 2;
+    if (statistics.median == 0) {
+        return half_width == 0 ? 0 : std::numeric_limits<double>::infinity();
+    }
+    return half_width / statistics.median;
+}
+
+// Whether the CI of every non-empty list of measurements is within config.target_relative_ci.
+bool have_converged(benchmark_config const& config,
+                    std::span<std::vector<double> const* const> measurements, std::mt19937_64& rg) {
+    return std::all_of(measurements.begin(), measurements.end(), [&](auto const* values) {
+        return values->empty() ||
+               relative_ci_half_width(compute_statistics(*values, rg)) <= *config.target_relative_ci;
+    });
+}
+
+std::size_t min_repetitions(benchmark_config const& config) {
+    return config.target_relative_ci ? std::max(config.repetitions, min_adaptive_repetitions)
+                                     : config.repetitions;
+}
+
+// Runs measure_once, which appends to some of the measurements, config.warmup_runs times and
+// then calls discard_warmup, then config.repetitions times. With config.target_relative_ci, it
+// goes on until the CI of every non-empty list of measurements is within the target or
+// config.max_duration_per_alg elapses since the start, and returns false in the latter case.
+template <class MeasureOnce, class DiscardWarmup>
+bool repeat_measurements(benchmark_config const& config, MeasureOnce const& measure_once,
+                         DiscardWarmup const& discard_warmup,
+                         std::initializer_list<std::vector<double> const*> measurements,
+                         std::mt19937_64& rg) {
+    auto const start_time = std::chrono::steady_clock::now();
+    if (config.warmup_runs != 0) {
+        for (std::size_t run = 0; run < config.warmup_runs; ++run) {
+            measure_once();
+        }
+        discard_warmup();
+    }
+
+    for (std::size_t repetition = 0; repetition < min_repetitions(config); ++repetition) {
+        measure_once();
+    }
+    if (!config.target_relative_ci) {
+        return true;
+    }
+    while (!have_converged(config, std::span{measurements.begin(), measurements.size()}, rg)) {
+        if (std::chrono::steady_clock::now() - start_time >= config.max_duration_per_alg) {
+            return false;
+        }
+        measure_once();
+    }
+    return true;
+}
+
+// Same as repeat_measurements for each of the indices, except that the measurements are taken in
+// rounds of one per index, in an order shuffled every round, so that drifts of the clock
+// frequency or of the load of the machine over the run affect all of them alike instead of
+// favoring the ones measured first. measure_once, discard_warmup and measurements_of take the
+// index. The time limit applies to the time spent measuring each index. Returns the indices that
+// hit it.
+template <class MeasureOnce, class DiscardWarmup, class MeasurementsOf>
+std::vector<std::size_t>
+repeat_measurements_interleaved(benchmark_config const& config, std::vector<std::size_t> indices,
+                                MeasureOnce const& measure_once, DiscardWarmup const& discard_warmup,
+                                MeasurementsOf const& measurements_of, std::mt19937_64& order_rg,
+                                std::mt19937_64& rg) {
+    std::vector<std::chrono::steady_clock::duration> elapsed(
+        indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end()) + 1);
+    auto const run_round = [&](std::vector<std::size_t>& round) {
+        std::shuffle(round.begin(), round.end(), order_rg);
+        for (auto const idx : round) {
+            auto const start_time = std::chrono::steady_clock::now();
+            measure_once(idx);
+            elapsed[idx] += std::chrono::steady_clock::now() - start_time;
+        }
+    };
+
+    for (std::size_t run = 0; run < config.warmup_runs; ++run) {
+        run_round(indices);
+    }
+    if (config.warmup_runs != 0) {
+        for (auto const idx : indices) {
+            discard_warmup(idx);
+        }
+    }
+    for (std::size_t repetition = 0; repetition < min_repetitions(config); ++repetition) {
+        run_round(indices);
+    }
+
+    std::vector<std::size_t> timed_out;
+    if (!config.target_relative_ci) {
+        return timed_out;
+    }
+    while (true) {
+        std::vector<std::size_t> remaining;
+        for (auto const idx : indices) {
+            auto const measurements = measurements_of(idx);
+            if (have_converged(config, measurements, rg)) {
+                continue;
+            }
+            if (elapsed[idx] >= config.max_duration_per_alg) {
+                timed_out.push_back(idx);
+            }
+            else {
+                remaining.push_back(idx);
+            }
+        }
+        if (remaining.empty()) {
+            std::sort(timed_out.begin(), timed_out.end());
+            return timed_out;
+        }
+        indices = remaining;
+        run_round(indices);
+    }
+}
+
+// Checks the selected candidates against the second one on the samples, printing the results
+// of all candidates for the first mismatch. Returns false if some candidate failed.
+template <class T>
+bool check_candidates_on_samples(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                                 std::span<T const> samples) {
+    auto const reference_function = benchmark_candidates[1].candidate_function;
+    for (auto const& sample : samples) {
+        auto const reference_result = (*reference_function)(sample);
+        for (auto itr = benchmark_candidates.cbegin() + 2; itr != benchmark_candidates.cend();
+             ++itr) {
+            if (!itr->selected || itr->candidate_function == nullptr) {
+                continue;
+            }
+            if ((*itr->candidate_function)(sample) != reference_result) {
                 std::cout << "Error detected!\n";
                 for (itr = benchmark_candidates.cbegin() + 1; itr != benchmark_candidates.cend();
                      ++itr) {
+                    if (itr->candidate_function == nullptr) {
+                        continue;
+                    }
                     auto const result = (*itr->candidate_function)(sample);
                     std::cout << "    " << std::setw(37) << itr->name << ": (" << result.trimmed_number
                               << ", " << result.number_of_removed_zeros << ")\n";
                 }
-                return;
+                return false;
+            }
+        }
+    }
+
+    std::vector<T> trimmed_numbers(samples.size());
+    std::vector<std::size_t> numbers_of_removed_zeros(samples.size());
+
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected || candidate.batch_candidate_function == nullptr) {
+            continue;
+        }
+        (*candidate.batch_candidate_function)(samples, trimmed_numbers, numbers_of_removed_zeros);
+        for (std::size_t idx = 0; idx < samples.size(); ++idx) {
+            auto const reference_result = (*reference_function)(samples[idx]);
+            if (remove_trailing_zeros_return<T>{trimmed_numbers[idx], numbers_of_removed_zeros[idx]} !=
+                reference_result) {
+                std::cout << "Error detected for the input " << samples[idx] << "!\n";
+                std::cout << "    " << std::setw(37) << benchmark_candidates[1].name << ": ("
+                          << reference_result.trimmed_number << ", "
+                          << reference_result.number_of_removed_zeros << ")\n";
+                std::cout << "    " << std::setw(37) << candidate.name << ": ("
+                          << trimmed_numbers[idx] << ", " << numbers_of_removed_zeros[idx] << ")\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Same as benchmark, but with the samples streamed from config.input_path in chunks of
+// config.number_of_samples. Each repetition is one pass over the whole file, timing every
+// candidate once on each chunk while the next one is read; the candidates are checked on the
+// first pass. Only throughput and latency are measured.
+template <class T>
+bool benchmark_file(std::vector<benchmark_candidate<T>>& benchmark_candidates,
+                    benchmark_config const& config) {
+    auto const mode = config.dispatch;
+    auto const measurement = config.measurement;
+
+    if (auto const error =
+            check_sample_distribution<T>(sample_distribution{}, config.min_digits, config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+    sample_file_reader<T> reader{config.input_path, config.input_format, config.min_digits,
+                                 config.max_digits, config.number_of_samples};
+    if (!reader.is_open()) {
+        std::cout << "Error: failed to open " << config.input_path << ".\n";
+        return false;
+    }
+
+    // Read through a volatile so that the compiler cannot see it is zero.
+    T volatile opaque_zero = 0;
+    std::mt19937_64 bootstrap_rg;
+
+    // Output buffers for batch candidates.
+    std::vector<T> trimmed_numbers(config.number_of_samples);
+    std::vector<std::size_t> numbers_of_removed_zeros(config.number_of_samples);
+
+    for (auto& candidate : benchmark_candidates) {
+        candidate.throughput_measurements.clear();
+        candidate.latency_measurements.clear();
+    }
+    for (std::size_t repetition = 0; repetition < config.repetitions; ++repetition) {
+        std::cout << "Streaming samples from " << config.input_path << " ("
+                  << name_of(config.input_format) << ", pass " << repetition + 1 << ")...\n";
+        if (repetition != 0) {
+            reader.rewind();
+        }
+
+        // Total time over all chunks, per candidate.
+        std::vector<double> throughput_nanoseconds(benchmark_candidates.size());
+        std::vector<double> latency_nanoseconds(benchmark_candidates.size());
+        std::uint64_t number_of_streamed_samples = 0;
+        std::size_t chunk_idx = 0;
+        for (auto samples = reader.next_chunk(); !samples.empty();
+             samples = reader.next_chunk(), ++chunk_idx) {
+            if (repetition == 0 && !check_candidates_on_samples(benchmark_candidates, samples)) {
+                return false;
+            }
+            number_of_streamed_samples += samples.size();
+            reader.wait_for_next_chunk();
+
+            // The first candidate timed on a chunk may find it still cold, so it rotates.
+            for (std::size_t offset = 0; offset < benchmark_candidates.size(); ++offset) {
+                auto const idx = (chunk_idx + offset) % benchmark_candidates.size();
+                auto const& candidate = benchmark_candidates[idx];
+                if (!candidate.selected) {
+                    continue;
+                }
+                if (measurement != measurement_mode::latency) {
+                    throughput_nanoseconds[idx] +=
+                        double(samples.size()) *
+                        measure_average_time_in_nanoseconds(
+                            [&] {
+                                run_throughput_pass(
+                                    candidate, mode, samples,
+                                    std::span<T>{trimmed_numbers}.first(samples.size()),
+                                    std::span<std::size_t>{numbers_of_removed_zeros}.first(
+                                        samples.size()));
+                            },
+                            samples.size(), std::chrono::milliseconds{0});
+                }
+                if (measurement != measurement_mode::throughput &&
+                    candidate.batch_candidate_function == nullptr) {
+                    T const zero = opaque_zero;
+                    latency_nanoseconds[idx] +=
+                        double(samples.size()) *
+                        measure_average_time_in_nanoseconds(
+                            [&] {
+                                if (mode == dispatch_mode::inlined) {
+                                    (*candidate.inlined_dependent_loop)(samples, zero);
+                                }
+                                else {
+                                    run_dependent_loop(candidate.candidate_function, samples, zero);
+                                }
+                            },
+                            samples.size(), std::chrono::milliseconds{0});
+                }
+            }
+        }
+
+        if (!reader.error().empty()) {
+            std::cout << "Error: " << reader.error() << ".\n";
+            return false;
+        }
+        if (number_of_streamed_samples == 0) {
+            std::cout << "Error: the file has no samples with " << config.min_digits << " to "
+                      << config.max_digits << " digits.\n";
+            return false;
+        }
+        if (repetition == 0) {
+            std::cout << number_of_streamed_samples << " samples, "
+                      << reader.number_of_skipped_samples()
+                      << " skipped for being zero or out of range.\n";
+        }
+
+        for (std::size_t idx = 0; idx < benchmark_candidates.size(); ++idx) {
+            auto& candidate = benchmark_candidates[idx];
+            if (!candidate.selected) {
+                continue;
+            }
+            if (measurement != measurement_mode::latency) {
+                candidate.throughput_measurements.push_back(throughput_nanoseconds[idx] /
+                                                            double(number_of_streamed_samples));
+            }
+            if (measurement != measurement_mode::throughput &&
+                candidate.batch_candidate_function == nullptr) {
+                candidate.latency_measurements.push_back(latency_nanoseconds[idx] /
+                                                         double(number_of_streamed_samples));
+            }
+        }
+    }
+
+    for (auto& candidate : benchmark_candidates) {
+        if (!candidate.throughput_measurements.empty()) {
+            candidate.throughput_statistics =
+                compute_statistics(candidate.throughput_measurements, bootstrap_rg);
+        }
+        if (!candidate.latency_measurements.empty()) {
+            candidate.latency_statistics =
+                compute_statistics(candidate.latency_measurements, bootstrap_rg);
+        }
+    }
+    std::cout << "Done.\n\n";
+    return true;
+}
+
+// The second candidate is used as the reference for verification, regardless of whether it is
+// selected. Returns false if the configuration is invalid or some candidate produced a wrong
+// result.
+template <class T>
+bool benchmark(std::vector<benchmark_candidate<T>>& benchmark_candidates,
+               benchmark_config const& config) {
+    if (!config.input_path.empty()) {
+        return benchmark_file(benchmark_candidates, config);
+    }
+    auto const number_of_samples = config.number_of_samples;
+    auto const mode = config.dispatch;
+    auto const measurement = config.measurement;
+
+    if (auto const error = check_sample_distribution<T>(config.distribution, config.min_digits,
+                                                        config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+
+    // Without a given seed, the one drawn is printed so that the run can be reproduced.
+    auto const seed = config.seed ? *config.seed : generate_random_seed();
+    std::cout << "Generating samples (" << describe(config.distribution) << ", seed " << seed
+              << ")...\n";
+    print_sample_distribution_notes<T>(config.distribution, config.min_digits, config.max_digits);
+    auto const samples = generate_random_samples<T>(number_of_samples, config.min_digits,
+                                                    config.max_digits, config.distribution, seed);
+
+    std::cout << "Verifying candidate algorithms...\n";
+    if (!check_candidates_on_samples(benchmark_candidates, std::span<T const>{samples})) {
+        return false;
+    }
+
+    // Output buffers for batch candidates.
+    std::vector<T> trimmed_numbers(number_of_samples);
+    std::vector<std::size_t> numbers_of_removed_zeros(number_of_samples);
+
+    // Read through a volatile so that the compiler cannot see it is zero.
+    T volatile opaque_zero = 0;
+    std::mt19937_64 bootstrap_rg;
+
+    std::optional<perf_counter_group> counters;
+    if (config.hardware_counters) {
+        counters.emplace();
+        if (!counters->available()) {
+            std::cout << "Hardware counters are unavailable (" << counters->error()
+                      << "); measuring time only.\n";
+            counters.reset();
+        }
+    }
+    auto const counters_ptr = counters ? &*counters : nullptr;
+    // Per candidate, since the interleaved schedule measures all of them in turn.
+    std::vector<std::vector<hardware_counter_values>> throughput_counters(
+        benchmark_candidates.size());
+    std::vector<std::vector<hardware_counter_values>> latency_counters(benchmark_candidates.size());
+
+    // Twice the size of the L1 data cache, so that reading it evicts everything else.
+    std::vector<std::byte> eviction_buffer;
+    if (config.l1_cold_block_size != 0) {
+        eviction_buffer.assign(2 * l1_data_cache_size(), std::byte{1});
+    }
+    std::optional<cold_call_disturbance> disturb_cold_call;
+    if (config.cold_calls.enabled()) {
+        disturb_cold_call.emplace(config.cold_calls);
+    }
+
+    // Each thread of the multi-threaded measurement needs its own output buffers.
+    std::vector<std::vector<T>> trimmed_numbers_per_thread(
+        config.cpus.size(), std::vector<T>(number_of_samples));
+    std::vector<std::vector<std::size_t>> numbers_of_removed_zeros_per_thread(
+        config.cpus.size(), std::vector<std::size_t>(number_of_samples));
+
+    auto const clear_measurements = [&](std::size_t idx) {
+        auto& candidate = benchmark_candidates[idx];
+        candidate.throughput_measurements.clear();
+        candidate.latency_measurements.clear();
+        candidate.l1_cold_measurements.clear();
+        candidate.cold_call_measurements.clear();
+        throughput_counters[idx].clear();
+        latency_counters[idx].clear();
+    };
+
+    auto const measure_once = [&](std::size_t idx) {
+        auto& candidate = benchmark_candidates[idx];
+        if (measurement != measurement_mode::latency) {
+            auto& counter_values = throughput_counters[idx].emplace_back();
+            candidate.throughput_measurements.push_back(measure_average_time_in_nanoseconds(
+                [&] {
+                    run_throughput_pass(candidate, mode, std::span<T const>{samples},
+                                        std::span<T>{trimmed_numbers},
+                                        std::span<std::size_t>{numbers_of_removed_zeros});
+                },
+                number_of_samples, config.min_duration_per_alg, counters_ptr, &counter_values));
+        }
+
+        if (measurement != measurement_mode::throughput &&
+            candidate.batch_candidate_function == nullptr) {
+            T const zero = opaque_zero;
+            auto& counter_values = latency_counters[idx].emplace_back();
+            candidate.latency_measurements.push_back(measure_average_time_in_nanoseconds(
+                [&] {
+                    if (mode == dispatch_mode::inlined) {
+                        (*candidate.inlined_dependent_loop)(samples, zero);
+                    }
+                    else {
+                        run_dependent_loop(candidate.candidate_function, std::span<T const>{samples},
+                                           zero);
+                    }
+                },
+                number_of_samples, config.min_duration_per_alg, counters_ptr, &counter_values));
+        }
+
+        if (config.l1_cold_block_size != 0 && measurement != measurement_mode::latency) {
+            candidate.l1_cold_measurements.push_back(measure_l1_cold_time_in_nanoseconds(
+                candidate, mode, std::span<T const>{samples}, std::span<T>{trimmed_numbers},
+                std::span<std::size_t>{numbers_of_removed_zeros}, eviction_buffer,
+                config.l1_cold_block_size, config.min_duration_per_alg));
+        }
+
+        if (disturb_cold_call) {
+            measure_cold_calls_in_nanoseconds(candidate, std::span<T const>{samples},
+                                              *disturb_cold_call, candidate.cold_call_measurements);
+        }
+    };
+
+    // The cold calls are not checked, since a repetition times thousands of them.
+    auto const measurements_of = [&](std::size_t idx) {
+        auto const& candidate = benchmark_candidates[idx];
+        return std::array<std::vector<double> const*, 3>{&candidate.throughput_measurements,
+                                                         &candidate.latency_measurements,
+                                                         &candidate.l1_cold_measurements};
+    };
+
+    // Computes the statistics, then measures the multi-threaded throughput, which is not
+    // interleaved.
+    auto const finish = [&](std::size_t idx) {
+        auto& candidate = benchmark_candidates[idx];
+        if (!candidate.throughput_measurements.empty()) {
+            candidate.throughput_statistics =
+                compute_statistics(candidate.throughput_measurements, bootstrap_rg);
+        }
+        if (!candidate.latency_measurements.empty()) {
+            candidate.latency_statistics =
+                compute_statistics(candidate.latency_measurements, bootstrap_rg);
+        }
+        if (!candidate.l1_cold_measurements.empty()) {
+            candidate.l1_cold_statistics =
+                compute_statistics(candidate.l1_cold_measurements, bootstrap_rg);
+        }
+        if (!candidate.cold_call_measurements.empty()) {
+            candidate.cold_call_statistics =
+                compute_statistics(candidate.cold_call_measurements, bootstrap_rg);
+        }
+        if (counters) {
+            if (!throughput_counters[idx].empty()) {
+                candidate.throughput_counters = average(throughput_counters[idx]);
+            }
+            if (!latency_counters[idx].empty()) {
+                candidate.latency_counters = average(latency_counters[idx]);
+            }
+        }
+
+        if (!config.cpus.empty() && measurement != measurement_mode::latency) {
+            candidate.multithreaded_throughput = measure_multithreaded_throughput(
+                [&](std::size_t thread_idx) {
+                    run_throughput_pass(
+                        candidate, mode, std::span<T const>{samples},
+                        std::span<T>{trimmed_numbers_per_thread[thread_idx]},
+                        std::span<std::size_t>{numbers_of_removed_zeros_per_thread[thread_idx]});
+                },
+                config.cpus, number_of_samples, config.min_duration_per_alg);
+            if (!candidate.multithreaded_throughput->pinned) {
+                std::cout << "Warning: some threads could not be pinned to their CPUs.\n";
+            }
+        }
+    };
+
+    std::vector<std::size_t> selected_indices;
+    for (std::size_t idx = 0; idx < benchmark_candidates.size(); ++idx) {
+        if (benchmark_candidates[idx].selected) {
+            selected_indices.push_back(idx);
+            clear_measurements(idx);
+        }
+    }
+
+    if (config.schedule == schedule_mode::sequential) {
+        for (auto const idx : selected_indices) {
+            std::cout << "Benchmarking " << benchmark_candidates[idx].name << "...\n";
+            auto const lists = measurements_of(idx);
+            if (!repeat_measurements(
+                    config, [&] { measure_once(idx); }, [&] { clear_measurements(idx); },
+                    {lists[0], lists[1], lists[2]}, bootstrap_rg)) {
+                std::cout << "Warning: stopped at the time limit before the 95% CI converged.\n";
+            }
+            finish(idx);
+        }
+    }
+    else {
+        // The order only depends on the seed of the samples, so that runs can be reproduced.
+        std::mt19937_64 order_rg{seed};
+        std::cout << "Benchmarking " << selected_indices.size()
+                  << " candidates in interleaved rounds...\n";
+        for (auto const idx : repeat_measurements_interleaved(config, selected_indices, measure_once,
+                                                              clear_measurements, measurements_of,
+                                                              order_rg, bootstrap_rg)) {
+            std::cout << "Warning: stopped " << benchmark_candidates[idx].name
+                      << " at the time limit before the 95% CI converged.\n";
+        }
+        for (auto const idx : selected_indices) {
+            finish(idx);
+        }
+    }
+    std::cout << "Done.\n\n";
+    return true;
+}
+
+// The median of the baseline, the first candidate, to subtract from those of the others as the
+// cost of the loop, of reading the clock and of consuming the results, if it was measured.
+template <class T, class MeasurementsOf, class StatisticsOf>
+std::optional<double>
+find_baseline_median(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                     bool subtract_baseline, MeasurementsOf const& measurements_of,
+                     StatisticsOf const& statistics_of) {
+    if (!subtract_baseline || benchmark_candidates.empty() ||
+        !benchmark_candidates.front().selected ||
+        measurements_of(benchmark_candidates.front()).empty()) {
+        return std::nullopt;
+    }
+    return statistics_of(benchmark_candidates.front()).median;
+}
+
+// Headers of the columns print_net_and_ticks writes.
+void print_net_and_ticks_header(bool net) {
+    if (net) {
+        std::cout << std::setw(10) << "net";
+    }
+    if (auto const unit = benchmark_timer.tick_unit(); !unit.empty()) {
+        std::cout << std::setw(12) << unit;
+        if (net) {
+            std::cout << std::setw(12) << "net " + std::string(unit);
+        }
+    }
+}
+
+// The median net of the baseline, then both in ticks of the timer if they are worth reporting,
+// which resolves differences below a nanosecond.
+void print_net_and_ticks(double median, std::optional<double> baseline_median) {
+    if (baseline_median) {
+        std::cout << std::setw(10) << median - *baseline_median;
+    }
+    if (!benchmark_timer.tick_unit().empty()) {
+        auto const ticks_per_nanosecond = benchmark_timer.ticks_per_nanosecond();
+        std::cout << std::setw(12) << median * ticks_per_nanosecond;
+        if (baseline_median) {
+            std::cout << std::setw(12) << (median - *baseline_median) * ticks_per_nanosecond;
+        }
+    }
+}
+
+template <class T>
+void print_statistics(std::vector<benchmark_candidate<T>> const& benchmark_candidates, bool latency,
+                      bool subtract_baseline) {
+    auto const measurements_of = [latency](benchmark_candidate<T> const& candidate) -> auto& {
+        return latency ? candidate.latency_measurements : candidate.throughput_measurements;
+    };
+    auto const statistics_of = [latency](benchmark_candidate<T> const& candidate) -> auto& {
+        return latency ? candidate.latency_statistics : candidate.throughput_statistics;
+    };
+    auto const baseline_median = find_baseline_median(benchmark_candidates, subtract_baseline,
+                                                      measurements_of, statistics_of);
+
+    std::cout << (latency ? "Latency" : "Throughput") << " in ns per sample:\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "median" << std::setw(10) << "min"
+              << std::setw(10) << "p90" << std::setw(10) << "stddev";
+    print_net_and_ticks_header(baseline_median.has_value());
+    std::cout << "   95% CI of median\n";
+
+    std::vector<benchmark_candidate<T> const*> ranking;
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected || measurements_of(candidate).empty()) {
+            continue;
+        }
+        auto const& statistics = statistics_of(candidate);
+        std::cout << std::setw(42) << candidate.name << std::setw(10) << statistics.median
+                  << std::setw(10) << statistics.min << std::setw(10) << statistics.p90
+                  << std::setw(10) << statistics.stddev;
+        print_net_and_ticks(statistics.median, baseline_median);
+        std::cout << "   [" << statistics.median_lower_bound << ", "
+                  << statistics.median_upper_bound << "]\n";
+        ranking.push_back(&candidate);
+    }
+
+    // Only neighbors in the ranking are compared, since those are the ones whose order is in
+    // question.
+    std::sort(ranking.begin(), ranking.end(), [&](auto const* x, auto const* y) {
+        return statistics_of(*x).median < statistics_of(*y).median;
+    });
+    std::mt19937_64 rg;
+    bool printed_header = false;
+    for (std::size_t idx = 1; idx < ranking.size(); ++idx) {
+        if (are_statistically_indistinguishable(measurements_of(*ranking[idx - 1]),
+                                                measurements_of(*ranking[idx]), rg)) {
+            if (!printed_header) {
+                std::cout << "Statistically indistinguishable (95% CI of the difference of the "
+                             "medians contains 0):\n";
+                printed_header = true;
+            }
+            std::cout << "    " << ranking[idx - 1]->name << " / " << ranking[idx]->name << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// Prints the median in ns and in ticks of the timer if they are worth reporting, e.g.
+// "3.2ns = 9.6 ticks", followed by the same net of the baseline if given.
+void print_median(double median, std::optional<double> baseline_median) {
+    auto const unit = benchmark_timer.tick_unit();
+    auto const print = [unit](double nanoseconds) {
+        std::cout << nanoseconds << "ns";
+        if (!unit.empty()) {
+            std::cout << " = " << nanoseconds * benchmark_timer.ticks_per_nanosecond() << " "
+                      << unit;
+        }
+    };
+    print(median);
+    if (baseline_median) {
+        std::cout << ", net ";
+        print(median - *baseline_median);
+    }
+}
+
+template <class T>
+void print_medians(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                   measurement_mode measurement, bool subtract_baseline) {
+    auto const baseline_median = [&](bool latency) {
+        return find_baseline_median(
+            benchmark_candidates, subtract_baseline,
+            [latency](benchmark_candidate<T> const& candidate) -> auto& {
+                return latency ? candidate.latency_measurements : candidate.throughput_measurements;
+            },
+            [latency](benchmark_candidate<T> const& candidate) -> auto& {
+                return latency ? candidate.latency_statistics : candidate.throughput_statistics;
+            });
+    };
+    auto const throughput_baseline_median = baseline_median(false);
+    auto const latency_baseline_median = baseline_median(true);
+
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected) {
+            continue;
+        }
+        std::cout << std::setw(42) << candidate.name << ": ";
+        if (measurement != measurement_mode::latency) {
+            print_median(candidate.throughput_statistics.median, throughput_baseline_median);
+            std::cout << " (throughput)";
+        }
+        if (measurement == measurement_mode::both) {
+            std::cout << ", ";
+        }
+        if (measurement != measurement_mode::throughput) {
+            if (candidate.batch_candidate_function == nullptr) {
+                print_median(candidate.latency_statistics.median, latency_baseline_median);
+                std::cout << " (latency)";
+            }
+            else {
+                std::cout << "n/a (latency)";
+            }
+        }
+        std::cout << "\n";
+    }
+}
+
+template <class T>
+void print_hardware_counters(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                             bool latency) {
+    std::cout << (latency ? "Latency" : "Throughput") << " hardware counters per sample:\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "cycles" << std::setw(10) << "instrs"
+              << std::setw(10) << "IPC" << std::setw(10) << "branches" << std::setw(10)
+              << "misses\n";
+    auto const flags = std::cout.flags();
+    auto const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto const& candidate : benchmark_candidates) {
+        auto const& counters = latency ? candidate.latency_counters : candidate.throughput_counters;
+        if (!candidate.selected || !counters) {
+            continue;
+        }
+        std::cout << std::setw(42) << candidate.name << std::setw(10) << counters->cycles
+                  << std::setw(10) << counters->instructions << std::setw(10)
+                  << (counters->cycles == 0 ? 0 : counters->instructions / counters->cycles)
+                  << std::setw(10) << counters->branches << std::setw(10) << counters->branch_misses
+                  << "\n";
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    std::cout << "\n";
+}
+
+enum class verification_mode {
+    // Every input for 32-bit, the edge cases for 64-bit.
+    full,
+    edges
+};
+
+// Edge cases: every k * 10^j for k up to 10^5 with its neighbors, and windows around boundaries
+// such as powers of 2 and 10 and the given domain limits of candidates, where inputs close by and
+// multiples of powers of 10 close by are checked. Sorted, without zero, and at most max_value.
+template <class T>
+std::vector<T> generate_edge_cases(T max_value, std::span<T const> domain_limits) {
+    constexpr T max = std::numeric_limits<T>::max();
+    constexpr T max_multiplier = 100000;
+    constexpr T dense_radius = T(1) << 12;
+    constexpr T multiple_radius = T(1) << 10;
+
+    std::vector<T> inputs;
+    auto const add = [&](T n) {
+        if (n != 0 && n <= max_value) {
+            inputs.push_back(n);
+        }
+    };
+    // Adds multiples of step in [center - radius * step, center + radius * step], clipped to the
+    // range of T.
+    auto const add_window = [&](T center, T step, T radius) {
+        auto const center_multiple = T(center / step);
+        auto const lower = T(center_multiple - std::min(center_multiple, radius));
+        auto const upper = T(center_multiple + std::min(T(max / step - center_multiple), radius));
+        for (auto multiple = lower;; ++multiple) {
+            add(T(multiple * step));
+            if (multiple == upper) {
+                break;
+            }
+        }
+    };
+
+    std::vector<T> powers_of_10;
+    for (T power = 1;; power *= 10) {
+        powers_of_10.push_back(power);
+        if (power > max / 10) {
+            break;
+        }
+    }
+
+    for (auto const power : powers_of_10) {
+        for (T k = 1; k <= max_multiplier && k <= max / power; ++k) {
+            auto const n = T(k * power);
+            add(T(n - 1));
+            add(n);
+            if (n != max) {
+                add(T(n + 1));
+            }
+        }
+    }
+
+    std::vector<T> boundaries = {max};
+    for (auto const power : powers_of_10) {
+        boundaries.push_back(power);
+    }
+    for (int exponent = 1; exponent < std::numeric_limits<T>::digits; ++exponent) {
+        boundaries.push_back(T(T(1) << exponent));
+    }
+    boundaries.insert(boundaries.end(), domain_limits.begin(), domain_limits.end());
+    for (auto const boundary : boundaries) {
+        add_window(boundary, 1, dense_radius);
+        for (auto const power : powers_of_10) {
+            if (power != 1) {
+                add_window(boundary, power, multiple_radius);
+            }
+        }
+    }
+
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    return inputs;
+}
+
+template <class T>
+struct verification_failure {
+    T input;
+    remove_trailing_zeros_return<T> actual_result;
+};
+
+// Checks every candidate against the second one on all inputs in [1, max_value] (full mode for
+// 32-bit), on the edge cases, or on the samples of input_reader if given, and reports the
+// smallest failing input of each candidate. For samples from a file, that is the smallest among
+// the first failures found by each thread. Each candidate is only checked on the inputs up to its
+// max_input, and the second one must support all of them. Returns false if some candidate failed.
+template <class T>
+bool verify(std::vector<benchmark_candidate<T>> const& benchmark_candidates, verification_mode mode,
+            T max_value, std::span<std::size_t const> cpus,
+            sample_file_reader<T>* input_reader = nullptr) {
+    constexpr std::size_t chunk_size = std::size_t(1) << 16;
+    auto const exhaustive = mode == verification_mode::full && sizeof(T) <= 4;
+
+    std::vector<T> edge_cases;
+    std::uint64_t number_of_inputs = max_value;
+    if (input_reader != nullptr) {
+        std::cout << "Verifying candidates on the samples of the input file...\n";
+    }
+    else if (exhaustive) {
+        std::cout << "Verifying candidates on all inputs up to " << max_value << "...\n";
+    }
+    else {
+        // The first input outside of the domain of each candidate, next to the last one inside.
+        std::vector<T> domain_limits;
+        for (auto const& candidate : benchmark_candidates) {
+            if (candidate.selected && candidate.max_input < max_value) {
+                domain_limits.push_back(T(candidate.max_input + 1));
+            }
+        }
+        edge_cases = generate_edge_cases<T>(max_value, domain_limits);
+        number_of_inputs = edge_cases.size();
+        std::cout << "Verifying candidates on " << number_of_inputs << " edge cases up to "
+                  << max_value << "...\n";
+    }
+
+    // One entry per thread and candidate. Each thread gets its chunks in ascending order, so the
+    // first failure it finds is its smallest, and the overall minimum is taken at the end.
+    auto const number_of_threads =
+        cpus.empty() ? std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1))
+                     : cpus.size();
+    std::vector<std::vector<std::optional<verification_failure<T>>>> first_failures(
+        number_of_threads,
+        std::vector<std::optional<verification_failure<T>>>(benchmark_candidates.size()));
+    auto const reference_function = benchmark_candidates[1].candidate_function;
+
+    auto const check_inputs = [&](std::span<T const> inputs, std::size_t thread_idx) {
+        std::vector<remove_trailing_zeros_return<T>> reference_results;
+        reference_results.reserve(inputs.size());
+        for (auto const input : inputs) {
+            reference_results.push_back((*reference_function)(input));
+        }
+
+        auto const largest_input =
+            inputs.empty() ? T(0) : *std::max_element(inputs.begin(), inputs.end());
+
+        std::vector<T> trimmed_numbers(inputs.size());
+        std::vector<std::size_t> numbers_of_removed_zeros(inputs.size());
+        // The inputs in the domain of a candidate and their reference results, if it does not
+        // cover all of them.
+        std::vector<T> domain_inputs;
+        std::vector<remove_trailing_zeros_return<T>> domain_reference_results;
+        auto& failures = first_failures[thread_idx];
+        for (std::size_t candidate_idx = 2; candidate_idx < benchmark_candidates.size();
+             ++candidate_idx) {
+            auto const& candidate = benchmark_candidates[candidate_idx];
+            auto& failure = failures[candidate_idx];
+            if (!candidate.selected || failure) {
+                continue;
+            }
+            auto candidate_inputs = inputs;
+            auto candidate_reference_results =
+                std::span<remove_trailing_zeros_return<T> const>{reference_results};
+            if (largest_input > candidate.max_input) {
+                domain_inputs.clear();
+                domain_reference_results.clear();
+                for (std::size_t idx = 0; idx < inputs.size(); ++idx) {
+                    if (inputs[idx] <= candidate.max_input) {
+                        domain_inputs.push_back(inputs[idx]);
+                        domain_reference_results.push_back(reference_results[idx]);
+                    }
+                }
+                candidate_inputs = domain_inputs;
+                candidate_reference_results = domain_reference_results;
+            }
+
+            if (candidate.batch_candidate_function != nullptr) {
+                (*candidate.batch_candidate_function)(
+                    candidate_inputs, std::span<T>{trimmed_numbers}.first(candidate_inputs.size()),
+                    std::span<std::size_t>{numbers_of_removed_zeros}.first(
+                        candidate_inputs.size()));
+            }
+            for (std::size_t idx = 0; idx < candidate_inputs.size(); ++idx) {
+                auto const result = candidate.batch_candidate_function != nullptr
+                                        ? remove_trailing_zeros_return<T>{trimmed_numbers[idx],
+                                                                          numbers_of_removed_zeros[idx]}
+                                        : (*candidate.candidate_function)(candidate_inputs[idx]);
+                if (result != candidate_reference_results[idx]) {
+                    failure = verification_failure<T>{candidate_inputs[idx], result};
+                    break;
+                }
+            }
+        }
+    };
+
+    auto const start_time = std::chrono::steady_clock::now();
+    if (input_reader != nullptr) {
+        number_of_inputs = 0;
+        for (auto inputs = input_reader->next_chunk(); !inputs.empty();
+             inputs = input_reader->next_chunk()) {
+            for_each_chunk_in_parallel(
+                (inputs.size() + chunk_size - 1) / chunk_size, cpus,
+                [&](std::size_t chunk_idx, std::size_t thread_idx) {
+                    auto const first = chunk_idx * chunk_size;
+                    check_inputs(inputs.subspan(first, std::min(chunk_size, inputs.size() - first)),
+                                 thread_idx);
+                });
+            number_of_inputs += inputs.size();
+        }
+        if (!input_reader->error().empty()) {
+            std::cout << "Error: " << input_reader->error() << ".\n";
+            return false;
+        }
+        if (number_of_inputs == 0) {
+            std::cout << "Error: the file has no samples with " << input_reader->min_digits()
+                      << " to " << input_reader->max_digits() << " digits.\n";
+            return false;
+        }
+        std::cout << number_of_inputs << " samples, " << input_reader->number_of_skipped_samples()
+                  << " skipped for being zero or out of range.\n";
+    }
+    else {
+        auto const number_of_chunks = std::size_t((number_of_inputs + chunk_size - 1) / chunk_size);
+        for_each_chunk_in_parallel(number_of_chunks, cpus, [&](std::size_t chunk_idx,
+                                                               std::size_t thread_idx) {
+            std::vector<T> inputs;
+            if (exhaustive) {
+                auto const first = std::uint64_t(chunk_idx) * chunk_size + 1;
+                auto const last = std::min(first + chunk_size - 1, std::uint64_t(max_value));
+                for (auto n = first; n <= last; ++n) {
+                    inputs.push_back(T(n));
+                }
+            }
+            else {
+                auto const first = chunk_idx * chunk_size;
+                auto const last = std::min(first + chunk_size, edge_cases.size());
+                inputs.assign(edge_cases.cbegin() + std::ptrdiff_t(first),
+                              edge_cases.cbegin() + std::ptrdiff_t(last));
+            }
+            check_inputs(inputs, thread_idx);
+        });
+    }
+    auto const duration = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Done in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()
+              << "ms on " << number_of_threads << " threads.\n\n";
+
+    bool succeeded = true;
+    for (std::size_t candidate_idx = 2; candidate_idx < benchmark_candidates.size();
+         ++candidate_idx) {
+        auto const& candidate = benchmark_candidates[candidate_idx];
+        if (!candidate.selected) {
+            continue;
+        }
+        std::optional<verification_failure<T>> first_failure;
+        for (auto const& failures : first_failures) {
+            auto const& failure = failures[candidate_idx];
+            if (failure && (!first_failure || failure->input < first_failure->input)) {
+                first_failure = failure;
+            }
+        }
+
+        std::cout << std::setw(42) << candidate.name << ": ";
+        if (!first_failure) {
+            std::cout << "passed";
+            if (candidate.max_input < max_value) {
+                std::cout << " up to " << candidate.max_input;
+            }
+            std::cout << "\n";
+            continue;
+        }
+        succeeded = false;
+        auto const& actual = first_failure->actual_result;
+        auto const expected = (*reference_function)(first_failure->input);
+        std::cout << "first failing input " << first_failure->input << ", got ("
+                  << actual.trimmed_number << ", " << actual.number_of_removed_zeros
+                  << "), expected (" << expected.trimmed_number << ", "
+                  << expected.number_of_removed_zeros << ")\n";
+    }
+    std::cout << "\n\n";
+    return succeeded;
+}
+
+// Speedup and efficiency are relative to the median single-threaded throughput.
+template <class T>
+void print_multithreaded_throughput(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                                    std::size_t number_of_threads) {
+    std::cout << "Multi-threaded throughput with " << number_of_threads << " threads:\n";
+    std::cout << std::setw(42) << "" << std::setw(14) << "Msamples/s" << std::setw(14)
+              << "ns/thread" << std::setw(10) << "speedup" << std::setw(12) << "efficiency\n";
+    for (auto const& candidate : benchmark_candidates) {
+        auto const& measured = candidate.multithreaded_throughput;
+        if (!candidate.selected || !measured) {
+            continue;
+        }
+        double average_nanoseconds_per_thread = 0;
+        for (auto const nanoseconds : measured->nanoseconds_per_thread) {
+            average_nanoseconds_per_thread += nanoseconds;
+        }
+        average_nanoseconds_per_thread /= double(number_of_threads);
+        auto const speedup =
+            measured->aggregate_samples_per_nanosecond * candidate.throughput_statistics.median;
+
+        std::cout << std::setw(42) << candidate.name << std::setw(14)
+                  << measured->aggregate_samples_per_nanosecond * 1000 << std::setw(14)
+                  << average_nanoseconds_per_thread << std::setw(10) << speedup << std::setw(10)
+                  << speedup / double(number_of_threads) * 100 << "%\n";
+    }
+    std::cout << "\n";
+}
+
+template <class T>
+void print_l1_cold_throughput(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                              std::size_t block_size, bool subtract_baseline) {
+    auto const baseline_median = find_baseline_median(
+        benchmark_candidates, subtract_baseline,
+        [](benchmark_candidate<T> const& candidate) -> auto& {
+            return candidate.l1_cold_measurements;
+        },
+        [](benchmark_candidate<T> const& candidate) -> auto& { return candidate.l1_cold_statistics; });
+
+    // The net and tick columns are of the cold median, which includes reading the clock around
+    // every block.
+    std::cout << "Throughput with the L1 data cache evicted every " << block_size
+              << " samples, in ns per sample (median):\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "cold" << std::setw(10) << "warm"
+              << std::setw(10) << "ratio";
+    print_net_and_ticks_header(baseline_median.has_value());
+    std::cout << "\n";
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected || candidate.l1_cold_measurements.empty()) {
+            continue;
+        }
+        auto const cold = candidate.l1_cold_statistics.median;
+        auto const warm = candidate.throughput_statistics.median;
+        std::cout << std::setw(42) << candidate.name << std::setw(10) << cold << std::setw(10)
+                  << warm << std::setw(10) << cold / warm;
+        print_net_and_ticks(cold, baseline_median);
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+template <class T>
+void print_cold_call_latency(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                             cold_call_config const& config, bool subtract_baseline) {
+    auto const baseline_median = find_baseline_median(
+        benchmark_candidates, subtract_baseline,
+        [](benchmark_candidate<T> const& candidate) -> auto& {
+            return candidate.cold_call_measurements;
+        },
+        [](benchmark_candidate<T> const& candidate) -> auto& {
+            return candidate.cold_call_statistics;
+        });
+
+    // The warm latency is only measured unless --measure=throughput.
+    auto const has_warm_latency = std::any_of(
+        benchmark_candidates.cbegin(), benchmark_candidates.cend(),
+        [](benchmark_candidate<T> const& candidate) {
+            return candidate.selected && !candidate.cold_call_measurements.empty() &&
+                   !candidate.latency_measurements.empty();
+        });
+
+    // The net and tick columns are of the median, which includes reading the clock twice.
+    std::cout << "Cold-call latency (" << describe(config) << "), in ns per call:\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "median" << std::setw(10) << "p90"
+              << std::setw(10) << "mean";
+    print_net_and_ticks_header(baseline_median.has_value());
+    if (has_warm_latency) {
+        std::cout << std::setw(10) << "warm";
+    }
+    std::cout << "\n";
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected || candidate.cold_call_measurements.empty()) {
+            continue;
+        }
+        auto const& statistics = candidate.cold_call_statistics;
+        std::cout << std::setw(42) << candidate.name << std::setw(10) << statistics.median
+                  << std::setw(10) << statistics.p90 << std::setw(10) << statistics.mean;
+        print_net_and_ticks(statistics.median, baseline_median);
+        if (!candidate.latency_measurements.empty()) {
+            std::cout << std::setw(10) << candidate.latency_statistics.median;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+template <class T>
+void print_results(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                   benchmark_config const& config) {
+    auto const measurement = config.measurement;
+
+    if (config.repetitions > 1 || config.target_relative_ci) {
+        if (measurement != measurement_mode::latency) {
+            print_statistics(benchmark_candidates, false, config.subtract_baseline);
+        }
+        if (measurement != measurement_mode::throughput) {
+            print_statistics(benchmark_candidates, true, config.subtract_baseline);
+        }
+    }
+    else {
+        print_medians(benchmark_candidates, measurement, config.subtract_baseline);
+        std::cout << "\n";
+    }
+
+    auto const has_counters = [&](bool latency) {
+        return std::any_of(benchmark_candidates.cbegin(), benchmark_candidates.cend(),
+                           [latency](benchmark_candidate<T> const& candidate) {
+                               return latency ? candidate.latency_counters.has_value()
+                                              : candidate.throughput_counters.has_value();
+                           });
+    };
+    if (has_counters(false)) {
+        print_hardware_counters(benchmark_candidates, false);
+    }
+    if (has_counters(true)) {
+        print_hardware_counters(benchmark_candidates, true);
+    }
+
+    if (!config.cpus.empty() && measurement != measurement_mode::latency) {
+        print_multithreaded_throughput(benchmark_candidates, config.cpus.size());
+    }
+    if (config.l1_cold_block_size != 0 && measurement != measurement_mode::latency) {
+        print_l1_cold_throughput(benchmark_candidates, config.l1_cold_block_size,
+                                 config.subtract_baseline);
+    }
+    if (config.cold_calls.enabled()) {
+        print_cold_call_latency(benchmark_candidates, config.cold_calls, config.subtract_baseline);
+    }
+}
+
+// Ranks the candidates of a schedule search by their median, skipping the baseline and the
+// naive reference.
+template <class T>
+void print_schedule_ranking(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                            measurement_mode measurement) {
+    auto const latency = measurement == measurement_mode::latency;
+    std::vector<benchmark_candidate<T> const*> ranking;
+    for (std::size_t idx = 2; idx < benchmark_candidates.size(); ++idx) {
+        if (benchmark_candidates[idx].selected) {
+            ranking.push_back(&benchmark_candidates[idx]);
+        }
+    }
+    if (ranking.empty()) {
+        return;
+    }
+    auto const median_of = [latency](benchmark_candidate<T> const* candidate) {
+        return latency ? candidate->latency_statistics.median
+                       : candidate->throughput_statistics.median;
+    };
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [&](auto const* lhs, auto const* rhs) { return median_of(lhs) < median_of(rhs); });
+
+    constexpr std::size_t max_rows = 10;
+    auto const flags = std::cout.flags();
+    auto const precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Fastest schedules by median " << (latency ? "latency" : "throughput") << ":\n";
+    for (std::size_t rank = 0; rank < std::min(max_rows, ranking.size()); ++rank) {
+        std::cout << std::setw(4) << rank + 1 << ". " << std::setw(56) << std::left
+                  << ranking[rank]->name << std::right << std::setw(10) << median_of(ranking[rank])
+                  << "ns" << std::setw(10) << std::setprecision(1)
+                  << (median_of(ranking[rank]) / median_of(ranking[0]) - 1) * 100 << "%\n"
+                  << std::setprecision(3);
+    }
+    std::cout << "\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+constexpr char const* name_of(generated::divisibility_test test) noexcept {
+    switch (test) {
+    case generated::divisibility_test::granlund_montgomery:
+        return "Granlund-Montgomery";
+    case generated::divisibility_test::generalized_granlund_montgomery:
+        return "Generalized Granlund-Montgomery";
+    case generated::divisibility_test::lemire:
+        return "Lemire";
+    }
+    return "";
+}
+
+// Formats a schedule the way the hand-written candidates are named, e.g. "8-2-1".
+std::string describe(generated::chunk_schedule const& schedule) {
+    std::string result;
+    for (std::size_t idx = 0; idx < schedule.size; ++idx) {
+        if (idx != 0) {
+            result += '-';
+        }
+        result += std::to_string(schedule.exponents[idx]);
+    }
+    return result;
+}
+
+// Appends the generated kernels for schedule with each divisibility test for which it is valid
+// up to max_n, either all branchy or all branchless.
+template <class UInt, UInt max_n, generated::chunk_schedule schedule>
+void append_generated_candidates(std::vector<benchmark_candidate<UInt>>& benchmark_candidates,
+                                 bool branchless, std::string_view suffix) {
+    using generated::divisibility_test;
+    auto const append = [&]<divisibility_test test>() {
+        auto name = std::string{name_of(test)} + " " + describe(schedule) +
+                    (branchless ? " branchless" : "") + std::string{suffix};
+        if constexpr (generated::is_valid_schedule<UInt, test, max_n, schedule>(true)) {
+            if (branchless) {
+                benchmark_candidates.push_back(make_candidate<
+                    generated::remove_trailing_zeros_branchless<UInt, test, max_n, schedule>>(
+                    std::move(name), max_n));
+                return;
+            }
+        }
+        if constexpr (generated::is_valid_schedule<UInt, test, max_n, schedule>(false)) {
+            if (!branchless) {
+                benchmark_candidates.push_back(
+                    make_candidate<generated::remove_trailing_zeros<UInt, test, max_n, schedule>>(
+                        std::move(name), max_n));
+            }
+        }
+    };
+    append.template operator()<divisibility_test::granlund_montgomery>();
+    append.template operator()<divisibility_test::lemire>();
+    append.template operator()<divisibility_test::generalized_granlund_montgomery>();
+}
+
+// Appends the range-specialized kernels for numbers with at most digits digits, with each
+// divisibility test for which they exist.
+template <class UInt, std::size_t digits>
+void append_bounded_candidates(std::vector<benchmark_candidate<UInt>>& benchmark_candidates) {
+    using generated::divisibility_test;
+    constexpr auto max_n = UInt(compute_power(UInt(10), digits) - 1);
+    auto const append = [&]<divisibility_test test>() {
+        if constexpr (generated::is_bounded_applicable<UInt, test, max_n>()) {
+            auto name = std::string{name_of(test)} + " branchless (up to " + std::to_string(digits) +
+                        " digits";
+            if constexpr (std::is_same_v<UInt, std::uint64_t> &&
+                          max_n <= std::numeric_limits<std::uint32_t>::max()) {
+                name += ", 32-bit";
+            }
+            benchmark_candidates.push_back(
+                make_candidate<generated::remove_trailing_zeros_bounded<UInt, test, max_n>>(
+                    std::move(name) + ")", max_n));
+        }
+    };
+    append.template operator()<divisibility_test::granlund_montgomery>();
+    append.template operator()<divisibility_test::lemire>();
+    append.template operator()<divisibility_test::generalized_granlund_montgomery>();
+}
+
+// The bounds are compile-time constants, so the kernels are instantiated for every number of
+// digits and the one for max_digits is picked.
+template <class UInt>
+void append_bounded_candidates(std::vector<benchmark_candidate<UInt>>& benchmark_candidates,
+                               std::size_t max_digits) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((max_digits == I + 1 ? append_bounded_candidates<UInt, I + 1>(benchmark_candidates)
+                              : void()),
+         ...);
+    }(std::make_index_sequence<std::size_t(std::numeric_limits<UInt>::digits10)>{});
+}
+
+std::vector<benchmark_candidate<std::uint32_t>> make_benchmark_candidates32() {
+    // Largest input of the candidates working for any number of digits.
+    constexpr auto any = std::numeric_limits<std::uint32_t>::max();
+    std::vector<benchmark_candidate<std::uint32_t>> benchmark_candidates = {
+        make_candidate<alg32::baseline>("Null (baseline)"),                                      //
+        make_candidate<alg32::naive>("Naive", any),                                              //
+        make_candidate<alg32::granlund_montgomery>("Granlund-Montgomery"),                       //
+        make_candidate<alg32::lemire>("Lemire"),                                                 //
+        make_candidate<alg32::generalized_granlund_montgomery>(
+            "Generalized Granlund-Montgomery"), //
+        make_candidate<alg32::naive_2_1>("Naive 2-1"),                                           //
+        make_candidate<alg32::granlund_montgomery_2_1>("Granlund-Montgomery 2-1"),               //
+        make_candidate<alg32::lemire_2_1>("Lemire 2-1"),                                         //
+        make_candidate<alg32::generalized_granlund_montgomery_2_1>(
+            "Generalized Granlund-Montgomery 2-1"), //
+        make_candidate<alg32::naive_branchless>("Naive branchless"),                             //
+        make_candidate<alg32::granlund_montgomery_branchless>("Granlund-Montgomery branchless"), //
+        make_candidate<alg32::lemire_branchless>("Lemire branchless"),                           //
+        make_candidate<alg32::generalized_granlund_montgomery_branchless>(
+            "Generalized Granlund-Montgomery branchless"),                                        //
+        make_candidate<alg32::ctz_inverse_table>("Count trailing zeros + inverse table", any),   //
+        make_candidate<alg32::residue_table>("Residue table", any),                              //
+        make_batch_candidate<alg32::batch::generalized_granlund_montgomery_branchless>(
+            std::string{"Generalized Granlund-Montgomery branchless ("} +
+            alg32::batch::instruction_set + " batch)") //
+    };
+    append_generated_candidates<std::uint32_t, 99999999, generated::chunk_schedule{{4, 2, 1}, 3}>(
+        benchmark_candidates, false, " (generated)");
+    return benchmark_candidates;
+}
+
+std::vector<benchmark_candidate<std::uint64_t>> make_benchmark_candidates64() {
+    // Largest input of the candidates working for any number of digits.
+    constexpr auto any = std::numeric_limits<std::uint64_t>::max();
+    std::vector<benchmark_candidate<std::uint64_t>> benchmark_candidates = {
+        make_candidate<alg64::baseline>("Null (baseline)"),                                      //
+        make_candidate<alg64::naive>("Naive", any),                                              //
+        make_candidate<alg64::granlund_montgomery>("Granlund-Montgomery"),                       //
+        make_candidate<alg64::lemire>("Lemire"),                                                 //
+        make_candidate<alg64::generalized_granlund_montgomery>(
+            "Generalized Granlund-Montgomery"), //
+        make_candidate<alg64::naive_2_1>("Naive 2-1"),                                           //
+        make_candidate<alg64::granlund_montgomery_2_1>("Granlund-Montgomery 2-1"),               //
+        make_candidate<alg64::lemire_2_1>("Lemire 2-1"),                                         //
+        make_candidate<alg64::generalized_granlund_montgomery_2_1>(
+            "Generalized Granlund-Montgomery 2-1"), //
+        make_candidate<alg64::naive_8_2_1>("Naive 8-2-1"),                                       //
+        make_candidate<alg64::granlund_montgomery_8_2_1>("Granlund-Montgomery 8-2-1"),           //
+        make_candidate<alg64::lemire_8_2_1>("Lemire 8-2-1", 47'795'296'599'999'998),            //
+        make_candidate<alg64::generalized_granlund_montgomery_8_2_1>(
+            "Generalized Granlund-Montgomery 8-2-1"), //
+        make_candidate<alg64::naive_branchless>("Naive branchless"),                             //
+        make_candidate<alg64::granlund_montgomery_branchless>("Granlund-Montgomery branchless"), //
+        make_candidate<alg64::lemire_branchless>("Lemire branchless"),                           //
+        make_candidate<alg64::generalized_granlund_montgomery_branchless>(
+            "Generalized Granlund-Montgomery branchless"),                                        //
+        make_candidate<alg64::ctz_inverse_table>("Count trailing zeros + inverse table", any),   //
+        make_candidate<alg64::residue_table>("Residue table", any),                              //
+        make_candidate<alg64::naive_split>("Naive split"),                                       //
+        make_candidate<alg64::granlund_montgomery_split>("Granlund-Montgomery split"),           //
+        make_candidate<alg64::lemire_split>("Lemire split"),                                     //
+        make_candidate<alg64::generalized_granlund_montgomery_split>(
+            "Generalized Granlund-Montgomery split"),                                             //
+        make_batch_candidate<alg64::batch::generalized_granlund_montgomery_branchless>(
+            std::string{"Generalized Granlund-Montgomery branchless ("} +
+            alg64::batch::instruction_set + " batch)"),                                          //
+        make_candidate<dispatch::remove_trailing_zeros64>("Dispatched")                          //
+    };
+    append_generated_candidates<std::uint64_t, 9999999999999999,
+                                generated::chunk_schedule{{4, 2, 1}, 3}>(benchmark_candidates, false,
+                                                                         " (generated)");
+    append_generated_candidates<std::uint64_t, 9999999999999999,
+                                generated::chunk_schedule{{8, 4, 2, 1}, 4}>(benchmark_candidates,
+                                                                            false, " (generated)");
+    return benchmark_candidates;
+}
+
+#if defined(__SIZEOF_INT128__)
+std::vector<benchmark_candidate<wuint::builtin_uint128_t>> make_benchmark_candidates128() {
+    return {
+        make_candidate<alg128::baseline>("Null (baseline)"),                                      //
+        make_candidate<alg128::naive>(
+            "Naive", std::numeric_limits<wuint::builtin_uint128_t>::max()), //
+        make_candidate<alg128::granlund_montgomery>("Granlund-Montgomery"),                       //
+        make_candidate<alg128::lemire>("Lemire"),                                                 //
+        make_candidate<alg128::generalized_granlund_montgomery>(
+            "Generalized Granlund-Montgomery"), //
+        make_candidate<alg128::naive_16_8_4_2_1>("Naive 16-8-4-2-1"),                             //
+        make_candidate<alg128::granlund_montgomery_16_8_4_2_1>(
+            "Granlund-Montgomery 16-8-4-2-1"),                                                    //
+        make_candidate<alg128::lemire_16_8_4_2_1>("Lemire 16-8-4-2-1"),                           //
+        make_candidate<alg128::generalized_granlund_montgomery_16_8_4_2_1>(
+            "Generalized Granlund-Montgomery 16-8-4-2-1"), //
+        make_candidate<alg128::naive_branchless>("Naive branchless"),                             //
+        make_candidate<alg128::granlund_montgomery_branchless>("Granlund-Montgomery branchless"), //
+        make_candidate<alg128::lemire_branchless>("Lemire branchless"),                           //
+        make_candidate<alg128::generalized_granlund_montgomery_branchless>(
+            "Generalized Granlund-Montgomery branchless") //
+    };
+}
+#endif
+
+// Chunks other than 1 the schedule search combines, largest first.
+constexpr std::size_t schedule_search_chunks[] = {16, 8, 4, 3, 2};
+constexpr std::size_t number_of_schedule_search_subsets = std::size_t(1)
+                                                          << std::size(schedule_search_chunks);
+
+// The schedule made of the chunks in the given subset of schedule_search_chunks, followed by 1.
+constexpr generated::chunk_schedule make_search_schedule(std::size_t subset) noexcept {
+    generated::chunk_schedule schedule;
+    for (std::size_t idx = 0; idx < std::size(schedule_search_chunks); ++idx) {
+        if (((subset >> idx) & 1) != 0) {
+            schedule.exponents[schedule.size++] = schedule_search_chunks[idx];
+        }
+    }
+    schedule.exponents[schedule.size++] = 1;
+    return schedule;
+}
+
+// Every valid schedule for inputs up to max_n, with every divisibility test, branchy and
+// branchless. The first two candidates are the same as in the regular benchmarks, so that the
+// results are comparable and the naive one serves as the reference for verification.
+template <class UInt, UInt max_n>
+std::vector<benchmark_candidate<UInt>> make_schedule_search_candidates() {
+    std::vector<benchmark_candidate<UInt>> benchmark_candidates;
+    if constexpr (std::is_same_v<UInt, std::uint32_t>) {
+        benchmark_candidates.push_back(make_candidate<alg32::baseline>("Null (baseline)"));
+        benchmark_candidates.push_back(
+            make_candidate<alg32::naive>("Naive", std::numeric_limits<std::uint32_t>::max()));
+    }
+    else {
+        benchmark_candidates.push_back(make_candidate<alg64::baseline>("Null (baseline)"));
+        benchmark_candidates.push_back(
+            make_candidate<alg64::naive>("Naive", std::numeric_limits<std::uint64_t>::max()));
+    }
+    [&]<std::size_t... subsets>(std::index_sequence<subsets...>) {
+        for (auto const branchless : {false, true}) {
+            (append_generated_candidates<UInt, max_n, make_search_schedule(subsets)>(
+                 benchmark_candidates, branchless, ""),
+             ...);
+        }
+    }(std::make_index_sequence<number_of_schedule_search_subsets>{});
+    return benchmark_candidates;
+}
+
+// The smallest instantiated domain covering numbers with max_digits digits. Returns an empty
+// list if there is none.
+template <class T>
+std::vector<benchmark_candidate<T>> make_schedule_search_candidates(std::size_t max_digits) {
+    if constexpr (std::is_same_v<T, std::uint32_t>) {
+        if (max_digits <= 8) {
+            return make_schedule_search_candidates<std::uint32_t, 99999999>();
+        }
+        if (max_digits <= 9) {
+            return make_schedule_search_candidates<std::uint32_t, 999999999>();
+        }
+    }
+    else if constexpr (std::is_same_v<T, std::uint64_t>) {
+        if (max_digits <= 16) {
+            return make_schedule_search_candidates<std::uint64_t, 9999999999999999>();
+        }
+        if (max_digits <= 19) {
+            return make_schedule_search_candidates<std::uint64_t, 9999999999999999999u>();
+        }
+    }
+    return {};
+}
+
+struct command_line_options {
+    bool show_help = false;
+    bool benchmark32 = true;
+    bool benchmark64 = true;
+    // Only supported if the compiler has unsigned __int128.
+    bool benchmark128 = true;
+    std::optional<std::regex> filter;
+    // Defaults to 8 for 32-bit, 16 for 64-bit and 34 for 128-bit.
+    std::optional<std::size_t> max_digits;
+    benchmark_config config;
+    // Paths of the machine-readable outputs; not written if empty.
+    std::string csv_path;
+    std::string json_path;
+    // CSV file written by a previous run to compare the results against.
+    std::string baseline_path;
+    double regression_threshold_percent = 5;
+    // Verify instead of benchmarking if set.
+    std::optional<verification_mode> verification;
+    // Replaces the candidates with every generated chunk schedule.
+    bool search_schedules = false;
+    // Benchmark the float-to-string pipeline instead of trailing zero removal alone.
+    bool pipeline = false;
+    // Benchmark the kernels also counting digits instead.
+    bool digit_count = false;
+    // Sweep the predictability of the number of trailing zeros instead.
+    bool entropy_sweep = false;
+    // gnuplot data file of the sweep; not written if empty.
+    std::string sweep_data_path;
+    // Benchmark the bulk API on an array of bulk_size_in_mib MiB instead.
+    bool bulk = false;
+    std::size_t bulk_size_in_mib = 256;
+    // Select the dispatched 64-bit kernel by timing the variants instead of from CPUID.
+    bool calibrate_dispatch = false;
+    // CSV files written by --csv to merge into one table instead of benchmarking.
+    std::vector<std::string> merge_paths;
+    // Print where the kernels of the candidates are instead of benchmarking.
+    bool list_kernels = false;
+    timer_source timer = timer_source::counter;
+};
+
+constexpr char const* usage = R"(Usage: rtz_benchmark [options]
+
+Options:
+  --bits=32|64|128|both|all    Which benchmarks to run; both means 32 and 64
+                               (default: all).
+  --filter=<regex>             Only run candidates whose names match the regex.
+  --samples=<n>                Number of samples, or of samples per chunk with
+                               --input (default: 100000).
+  --min-digits=<n>             Minimum number of digits of samples (default: 1).
+  --max-digits=<n>             Maximum number of digits of samples
+                               (default: 8 for 32-bit, 16 for 64-bit, 34 for
+                               128-bit; at most 9, 19 and 38).
+  --distribution=<name>        Sample distribution; one of
+                                 uniform-digits-and-zeros (default),
+                                 uniform,
+                                 fixed-zeros:<number of trailing zeros>,
+                                 histogram:<file>,
+                                 dragonbox.
+  --duration=<ms>              Minimum duration per candidate (default: 1500).
+  --repetitions=<n>            Number of measurements per candidate (default: 1). With more
+                               than one, prints statistics over the measurements.
+  --target-ci=<percent>        Repeat the measurements of each candidate, at
+                               least 5 and --repetitions times, until the 95% CI
+                               of every median is within the given percentage of
+                               it, e.g. 1; --duration then defaults to 50.
+  --max-duration=<ms>          Time limit per candidate for --target-ci
+                               (default: 10000).
+  --warmup=<n>                 Number of measurements per candidate to discard
+                               before the repetitions (default: 0, or 1 with
+                               --target-ci).
+  --schedule=sequential|interleaved
+                               Measure the candidates one after another
+                               (default), or in rounds of one measurement each
+                               in an order shuffled every round, which spreads
+                               frequency drift evenly; --repetitions then
+                               defaults to 10 and --duration to 50.
+  --seed=<n>                   Seed for samples reproducible on every machine
+                               (default: random, printed).
+  --dispatch=inlined|function-pointer
+                               How candidates are called (default: inlined).
+  --measure=throughput|latency|both
+                               What to measure (default: both).
+  --perf-counters              Also report cycles, instructions, IPC, branches and
+                               branch misses per sample (Linux perf_event only).
+  --timer=counter|steady-clock How to time; counter reads the invariant TSC with
+                               rdtscp on x86 or cntvct_el0 on AArch64, calibrated
+                               against steady_clock, and reports the medians in
+                               its ticks as well (default: counter if available).
+  --no-subtract-baseline       Do not report the medians net of the Null
+                               (baseline) candidate, nor measure it when
+                               --filter leaves it out.
+  --cpus=<list>                Also measure throughput with one thread pinned to
+                               each listed CPU, e.g. 0-3 or 0,2,4-7. List both
+                               logical CPUs of a core to load SMT siblings.
+  --l1-cold[=<n>]              Also measure throughput with the L1 data cache
+                               evicted before every n samples (default: 16),
+                               timing only the samples.
+  --cold-calls=<list>          Also time single calls, each after the listed
+                               disturbances: data[:<KB>] (read a buffer, twice
+                               the L2 cache by default), instructions (run code
+                               larger than the L1 i-cache), branches (run random
+                               branches), filler:<n> (n iterations of filler
+                               work), or all (data, instructions, branches).
+  --input=<file>               Stream the samples from a file instead of
+                               generating them, reading the next chunk of
+                               --samples samples while the current one is
+                               benchmarked or verified. Samples that are zero or
+                               without --min-digits to --max-digits digits are
+                               skipped.
+  --input-format=text|binary|float|double
+                               Format of --input: whitespace-separated decimal
+                               integers, native-endian integers of the
+                               benchmarked width, or native-endian floats or
+                               doubles converted as for --distribution=dragonbox
+                               (default: text).
+  --pipeline                   Instead, time trimming the significands of random
+                               floats (32-bit) and doubles (64-bit), or of those
+                               in --input with --input-format=float|double, and
+                               printing the numbers, against std::to_chars.
+  --digit-count                Instead, time the branchless kernels alongside a
+                               digit count of the input against the same kernels
+                               followed by a digit count of the trimmed number.
+  --entropy-sweep              Instead, time the candidates on numbers with
+                               --max-digits digits whose numbers of trailing
+                               zeros go from constant through sorted and
+                               periodic to independent with growing entropy,
+                               and show the fastest one for each; --duration
+                               then defaults to 100.
+  --sweep-data=<file>          Write the medians of --entropy-sweep as gnuplot
+                               data, one block per bits and metric.
+  --bulk                       Instead, time the in-place bulk API on an array
+                               of --bulk-size MiB with and without prefetching
+                               and non-temporal stores, on one and on all
+                               threads, in GB/s against STREAM-style copy and
+                               scale loops; --repetitions then defaults to 5.
+  --bulk-size=<MiB>            Size of the array of --bulk (default: 256).
+  --calibrate-dispatch         Select the 64-bit kernel of the Dispatched
+                               candidate by briefly timing every variant the CPU
+                               supports, instead of from CPUID.
+  --csv=<file>                 Write the results with metadata as CSV.
+  --json=<file>                Write the results with metadata as JSON.
+  --compare=<file>             Compare the results with a CSV file written by
+                               --csv and fail if some median regressed.
+  --threshold=<percent>        Regression threshold for --compare (default: 5).
+  --merge=<file>[,<file>...]   Instead of benchmarking, print the medians in CSV
+                               files written by --csv, e.g. by the builds of the
+                               benchmark matrix, side by side as a Markdown table.
+  --verify[=full|edges]        Instead of benchmarking, check all candidates on
+                               all cores or on --cpus, and report the first
+                               failing input of each. full checks every 32-bit
+                               input; edges, which full also means for 64-bit
+                               and 128-bit, checks edge cases up to the largest
+                               value. Both stop at --max-digits digits if given,
+                               and check each candidate only within its domain.
+  --list-kernels               Instead, print the bits, the address relative to
+                               rtz_benchmark_kernel_address_anchor and the name
+                               of the kernel of every candidate, separated by
+                               tabs, for cmake/codegen-report.cmake.
+  --search-schedules           Benchmark (or verify) generated kernels for every
+                               chunk schedule combining 16, 8, 4, 3, 2 and 1
+                               instead, and rank them.
+  --help                       Print this message.
+)";
+
+template <class UInt>
+bool parse_unsigned(std::string_view str, UInt& value) {
+    auto const last = str.data() + str.size();
+    auto const result = std::from_chars(str.data(), last, value);
+    return result.ec == std::errc{} && result.ptr == last;
+}
+
+// One row of the machine-readable output.
+struct result_record {
+    std::size_t bits = 0;
+    std::size_t min_digits = 0;
+    std::size_t max_digits = 0;
+    std::string candidate;
+    // "throughput", "latency", "l1-cold", "cold-call", "pipeline" or "bulk".
+    std::string metric;
+    std::size_t repetitions = 0;
+    measurement_statistics statistics;
+    std::optional<hardware_counter_values> counters;
+};
+
+template <class T>
+void append_result_records(std::vector<benchmark_candidate<T>> const& benchmark_candidates,
+                           benchmark_config const& config, std::vector<result_record>& records) {
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected) {
+            continue;
+        }
+        auto const append = [&](char const* metric, std::vector<double> const& measurements,
+                                measurement_statistics const& statistics,
+                                std::optional<hardware_counter_values> const& counters) {
+            if (!measurements.empty()) {
+                records.push_back({std::size_t(std::numeric_limits<T>::digits), config.min_digits,
+                                   config.max_digits, candidate.name, metric, measurements.size(),
+                                   statistics, counters});
+            }
+        };
+        append("throughput", candidate.throughput_measurements, candidate.throughput_statistics,
+               candidate.throughput_counters);
+        append("latency", candidate.latency_measurements, candidate.latency_statistics,
+               candidate.latency_counters);
+        append("l1-cold", candidate.l1_cold_measurements, candidate.l1_cold_statistics,
+               std::nullopt);
+        append("cold-call", candidate.cold_call_measurements, candidate.cold_call_statistics,
+               std::nullopt);
+    }
+}
+
+// Describes where and how the results were obtained.
+struct run_metadata {
+    std::string build;
+    std::string host;
+    std::string cpu;
+    std::string compiler;
+    std::string instruction_set;
+    std::string dispatched_kernel64;
+    std::string timer;
+    std::string timestamp;
+    benchmark_config config;
+};
+
+std::string describe_samples(benchmark_config const& config) {
+    if (config.input_path.empty()) {
+        return describe(config.distribution);
+    }
+    return "file " + config.input_path + " (" + name_of(config.input_format) + ")";
+}
+
+run_metadata collect_run_metadata(benchmark_config const& config) {
+    run_metadata metadata;
+    metadata.build = RTZ_BENCHMARK_BUILD_VARIANT;
+    metadata.host = "unknown";
+    metadata.cpu = "unknown";
+#if defined(__linux__)
+    char host[256] = {};
+    if (gethostname(host, sizeof(host) - 1) == 0) {
+        metadata.host = host;
+    }
+    std::ifstream cpuinfo{"/proc/cpuinfo"};
+    for (std::string line; std::getline(cpuinfo, line);) {
+        if (line.starts_with("model name")) {
+            if (auto const colon = line.find(':'); colon != std::string::npos) {
+                metadata.cpu = line.substr(line.find_first_not_of(' ', colon + 1));
+            }
+            break;
+        }
+    }
+#endif
+
+#if defined(__clang__)
+    metadata.compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+    metadata.compiler = "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+    metadata.compiler = "MSVC " + std::to_string(_MSC_FULL_VER);
+#else
+    metadata.compiler = "unknown";
+#endif
+    metadata.instruction_set = alg32::batch::instruction_set;
+    metadata.dispatched_kernel64 = dispatch::selected_variant64().name;
+    std::ostringstream timer;
+    timer << benchmark_timer.name() << " (" << benchmark_timer.ticks_per_nanosecond()
+          << " ticks per ns)";
+    metadata.timer = timer.str();
+
+    auto const now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::ostringstream timestamp;
+    timestamp << std::put_time(std::gmtime(&now), "%Y-%m-%dT%H:%M:%SZ");
+    metadata.timestamp = timestamp.str();
+    metadata.config = config;
+    return metadata;
+}
+
+// Pairs of keys and values of the metadata, in output order.
+std::vector<std::pair<std::string, std::string>> list_metadata(run_metadata const& metadata) {
+    auto const& config = metadata.config;
+    return {{"build", metadata.build},
+            {"host", metadata.host},
+            {"cpu", metadata.cpu},
+            {"compiler", metadata.compiler},
+            {"instruction_set", metadata.instruction_set},
+            {"dispatched_kernel64", metadata.dispatched_kernel64},
+            {"timer", metadata.timer},
+            {"timestamp", metadata.timestamp},
+            {"samples", std::to_string(config.number_of_samples)},
+            {"distribution", describe_samples(config)},
+            {"duration_ms", std::to_string(config.min_duration_per_alg.count())},
+            {"target_ci_percent",
+             config.target_relative_ci ? std::to_string(*config.target_relative_ci * 100) : "none"},
+            {"max_duration_ms", std::to_string(config.max_duration_per_alg.count())},
+            {"warmup", std::to_string(config.warmup_runs)},
+            {"schedule", config.schedule == schedule_mode::sequential ? "sequential" : "interleaved"},
+            {"seed", config.seed ? std::to_string(*config.seed) : "random"},
+            {"dispatch",
+             config.dispatch == dispatch_mode::inlined ? "inlined" : "function-pointer"}};
+}
+
+std::string quote_csv(std::string_view str) {
+    std::string result = "\"";
+    for (auto const c : str) {
+        if (c == '"') {
+            result += '"';
+        }
+        result += c;
+    }
+    return result + '"';
+}
+
+std::string quote_json(std::string_view str) {
+    std::string result = "\"";
+    for (auto const c : str) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", unsigned(c));
+            result += escaped;
+        }
+        else {
+            result += c;
+        }
+    }
+    return result + '"';
+}
+
+constexpr char const* csv_columns =
+    "bits,min_digits,max_digits,candidate,metric,repetitions,median_ns,mean_ns,min_ns,p90_ns,"
+    "stddev_ns,ci_lower_ns,ci_upper_ns,cycles,instructions,branches,branch_misses";
+
+// Metadata goes into leading comment lines of the form "# key: value".
+void write_csv(std::ostream& out, run_metadata const& metadata,
+               std::vector<result_record> const& records) {
+    for (auto const& [key, value] : list_metadata(metadata)) {
+        out << "# " << key << ": " << value << "\n";
+    }
+    out << csv_columns << "\n";
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (auto const& record : records) {
+        auto const& statistics = record.statistics;
+        out << record.bits << "," << record.min_digits << "," << record.max_digits << ","
+            << quote_csv(record.candidate) << "," << record.metric << "," << record.repetitions
+            << "," << statistics.median << "," << statistics.mean << "," << statistics.min << ","
+            << statistics.p90 << "," << statistics.stddev << "," << statistics.median_lower_bound
+            << "," << statistics.median_upper_bound;
+        if (record.counters) {
+            out << "," << record.counters->cycles << "," << record.counters->instructions << ","
+                << record.counters->branches << "," << record.counters->branch_misses;
+        }
+        else {
+            out << ",,,,";
+        }
+        out << "\n";
+    }
+}
+
+void write_json(std::ostream& out, run_metadata const& metadata,
+                std::vector<result_record> const& records) {
+    out << "{\n  \"metadata\": {";
+    bool first = true;
+    for (auto const& [key, value] : list_metadata(metadata)) {
+        out << (first ? "\n" : ",\n") << "    " << quote_json(key) << ": " << quote_json(value);
+        first = false;
+    }
+    out << "\n  },\n  \"results\": [";
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    first = true;
+    for (auto const& record : records) {
+        auto const& statistics = record.statistics;
+        out << (first ? "\n" : ",\n") << "    {\"bits\": " << record.bits
+            << ", \"min_digits\": " << record.min_digits << ", \"max_digits\": " << record.max_digits
+            << ", \"candidate\": " << quote_json(record.candidate) << ", \"metric\": \""
+            << record.metric << "\", \"repetitions\": " << record.repetitions
+            << ", \"median_ns\": " << statistics.median << ", \"mean_ns\": " << statistics.mean
+            << ", \"min_ns\": " << statistics.min << ", \"p90_ns\": " << statistics.p90
+            << ", \"stddev_ns\": " << statistics.stddev
+            << ", \"ci_lower_ns\": " << statistics.median_lower_bound
+            << ", \"ci_upper_ns\": " << statistics.median_upper_bound;
+        if (record.counters) {
+            out << ", \"cycles\": " << record.counters->cycles
+                << ", \"instructions\": " << record.counters->instructions
+                << ", \"branches\": " << record.counters->branches
+                << ", \"branch_misses\": " << record.counters->branch_misses;
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Splits a line of the CSV written by write_csv into its fields.
+std::vector<std::string> split_csv_line(std::string_view line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (std::size_t idx = 0; idx < line.size(); ++idx) {
+        auto const c = line[idx];
+        if (quoted) {
+            if (c != '"') {
+                fields.back() += c;
+            }
+            else if (idx + 1 < line.size() && line[idx + 1] == '"') {
+                fields.back() += '"';
+                ++idx;
+            }
+            else {
+                quoted = false;
+            }
+        }
+        else if (c == '"') {
+            quoted = true;
+        }
+        else if (c == ',') {
+            fields.emplace_back();
+        }
+        else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// Reads the medians of a file written by write_csv, keyed by bits, candidate and metric, and its
+// metadata if requested. Returns false if the file could not be parsed.
+bool read_baseline(std::istream& in, std::vector<result_record>& records,
+                   std::vector<std::pair<std::string, std::string>>* metadata = nullptr) {
+    records.clear();
+    bool read_header = false;
+    for (std::string line; std::getline(in, line);) {
+        if (line.starts_with("# ") && metadata != nullptr) {
+            if (auto const separator = line.find(": "); separator != std::string::npos) {
+                metadata->emplace_back(line.substr(2, separator - 2), line.substr(separator + 2));
+            }
+            continue;
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (!read_header) {
+            if (line != csv_columns) {
+                return false;
+            }
+            read_header = true;
+            continue;
+        }
+
+        auto const fields = split_csv_line(line);
+        result_record record;
+        if (fields.size() != 17 || !parse_unsigned(fields[0], record.bits) ||
+            !parse_unsigned(fields[1], record.min_digits) ||
+            !parse_unsigned(fields[2], record.max_digits)) {
+            return false;
+        }
+        record.candidate = fields[3];
+        record.metric = fields[4];
+        auto const& median = fields[6];
+        auto const result =
+            std::from_chars(median.data(), median.data() + median.size(), record.statistics.median);
+        if (result.ec != std::errc{} || result.ptr != median.data() + median.size()) {
+            return false;
+        }
+        records.push_back(std::move(record));
+    }
+    return read_header;
+}
+
+// Prints how each result differs from the baseline result with the same bits, numbers of digits,
+// candidate and metric. Nothing is compared if the baseline samples were drawn from another
+// distribution. Returns false if some median got slower by more than threshold_percent.
+bool compare_with_baseline(std::vector<result_record> const& records,
+                           std::vector<result_record> const& baseline,
+                           std::string_view distribution, std::string_view baseline_distribution,
+                           double threshold_percent) {
+    std::cout << "Comparison with the baseline (regression threshold " << threshold_percent
+              << "%):\n";
+    if (distribution != baseline_distribution) {
+        std::cout << "The baseline samples are " << baseline_distribution << ", not "
+                  << distribution << "; no result is compared.\n\n";
+        return true;
+    }
+    std::cout << std::setw(42) << "" << std::setw(6) << "bits" << std::setw(12) << "metric"
+              << std::setw(12) << "baseline" << std::setw(12) << "current" << std::setw(10)
+              << "change\n";
+    std::size_t number_of_regressions = 0;
+    for (auto const& record : records) {
+        auto const match = std::find_if(baseline.cbegin(), baseline.cend(), [&](auto const& entry) {
+            return entry.bits == record.bits && entry.min_digits == record.min_digits &&
+                   entry.max_digits == record.max_digits && entry.candidate == record.candidate &&
+                   entry.metric == record.metric;
+        });
+        if (match == baseline.cend()) {
+            continue;
+        }
+        auto const change_percent =
+            (record.statistics.median / match->statistics.median - 1) * 100;
+        std::cout << std::setw(42) << record.candidate << std::setw(6) << record.bits
+                  << std::setw(12) << record.metric << std::setw(12) << match->statistics.median
+                  << std::setw(12) << record.statistics.median << std::setw(9) << change_percent
+                  << "%";
+        if (change_percent > threshold_percent) {
+            std::cout << "  REGRESSION";
+            ++number_of_regressions;
+        }
+        std::cout << "\n";
+    }
+    std::cout << number_of_regressions << " regression(s) found.\n\n";
+    return number_of_regressions == 0;
+}
+
+// Prints the medians of several files written by write_csv as a Markdown table, with a row per
+// bits, candidate and metric in order of first appearance, and a column per file labeled by its
+// build and compiler. Returns false if some file could not be read.
+bool print_merged_results(std::vector<std::string> const& paths) {
+    struct row_key {
+        std::size_t bits;
+        std::string candidate;
+        std::string metric;
+        bool operator==(row_key const&) const = default;
+    };
+    std::vector<row_key> rows;
+    std::vector<std::string> labels;
+    std::vector<std::vector<result_record>> results;
+    for (auto const& path : paths) {
+        std::ifstream file{path};
+        std::vector<result_record> records;
+        std::vector<std::pair<std::string, std::string>> metadata;
+        if (!file || !read_baseline(file, records, &metadata)) {
+            std::cerr << "Failed to read the results from " << path << "\n";
+            return false;
+        }
+        auto const find_metadata = [&](std::string_view key) -> std::string {
+            auto const it = std::find_if(metadata.cbegin(), metadata.cend(),
+                                         [&](auto const& entry) { return entry.first == key; });
+            return it == metadata.cend() ? std::string{} : it->second;
+        };
+        auto label = find_metadata("build");
+        if (label.empty()) {
+            label = path;
+        }
+        if (auto const compiler = find_metadata("compiler"); !compiler.empty()) {
+            label += " (" + compiler + ")";
+        }
+        labels.push_back(std::move(label));
+
+        for (auto const& record : records) {
+            row_key key{record.bits, record.candidate, record.metric};
+            if (std::find(rows.cbegin(), rows.cend(), key) == rows.cend()) {
+                rows.push_back(std::move(key));
+            }
+        }
+        results.push_back(std::move(records));
+    }
+
+    std::cout << "| bits | candidate | metric |";
+    for (auto const& label : labels) {
+        std::cout << " " << label << " |";
+    }
+    std::cout << "\n|---:|---|---|";
+    for (std::size_t idx = 0; idx < labels.size(); ++idx) {
+        std::cout << "---:|";
+    }
+    std::cout << "\n";
+    for (auto const& row : rows) {
+        std::cout << "| " << row.bits << " | " << row.candidate << " | " << row.metric << " |";
+        for (auto const& records : results) {
+            auto const match = std::find_if(records.cbegin(), records.cend(), [&](auto const& entry) {
+                return row == row_key{entry.bits, entry.candidate, entry.metric};
+            });
+            if (match == records.cend()) {
+                std::cout << " - |";
+            }
+            else {
+                std::cout << " " << match->statistics.median << " |";
+            }
+        }
+        std::cout << "\n";
+    }
+    return true;
+}
+
+// Parses a comma-separated list of CPU numbers and ranges like 0,2,4-7.
+bool parse_cpu_list(std::string_view str, std::vector<std::size_t>& cpus) {
+    cpus.clear();
+    while (true) {
+        auto const separator = str.find(',');
+        auto const item = str.substr(0, separator);
+        auto const dash = item.find('-');
+        std::size_t first;
+        std::size_t last;
+        if (dash == std::string_view::npos) {
+            if (!parse_unsigned(item, first)) {
+                return false;
+            }
+            last = first;
+        }
+        else if (!parse_unsigned(item.substr(0, dash), first) ||
+                 !parse_unsigned(item.substr(dash + 1), last) || last < first) {
+            return false;
+        }
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+
+        if (separator == std::string_view::npos) {
+            return true;
+        }
+        str.remove_prefix(separator + 1);
+    }
+}
+
+// Parses a comma-separated list of disturbances like data:4096,instructions,filler:100.
+bool parse_cold_call_config(std::string_view str, cold_call_config& config) {
+    config = {};
+    while (true) {
+        auto const separator = str.find(',');
+        auto const item = str.substr(0, separator);
+        if (item == "data" || item == "all") {
+            config.data_bytes = 2 * l2_cache_size();
+        }
+        if (item == "instructions" || item == "all") {
+            config.instructions = true;
+        }
+        if (item == "branches" || item == "all") {
+            config.branches = true;
+        }
+
+        std::size_t value;
+        if (item.starts_with("data:")) {
+            if (!parse_unsigned(item.substr(5), value) || value == 0) {
+                return false;
+            }
+            config.data_bytes = value * 1024;
+        }
+        else if (item.starts_with("filler:")) {
+            if (!parse_unsigned(item.substr(7), value) || value == 0) {
+                return false;
+            }
+            config.filler_iterations = value;
+        }
+        else if (item != "data" && item != "instructions" && item != "branches" && item != "all") {
+            return false;
+        }
+
+        if (separator == std::string_view::npos) {
+            return true;
+        }
+        str.remove_prefix(separator + 1);
+    }
+}
+
+// Returns false after printing a message if the arguments could not be parsed.
+bool parse_command_line(int argc, char** argv, command_line_options& options) {
+    bool duration_given = false;
+    bool repetitions_given = false;
+    bool warmup_given = false;
+    for (int arg_idx = 1; arg_idx < argc; ++arg_idx) {
+        std::string_view const arg = argv[arg_idx];
+        auto const separator = arg.find('=');
+        auto const name = arg.substr(0, separator);
+        auto const value =
+            separator == std::string_view::npos ? std::string_view{} : arg.substr(separator + 1);
+        auto& config = options.config;
+        bool valid = true;
+
+        if (name == "--help") {
+            options.show_help = true;
+        }
+        else if (name == "--bits") {
+            options.benchmark32 = value == "32" || value == "both" || value == "all";
+            options.benchmark64 = value == "64" || value == "both" || value == "all";
+            options.benchmark128 = value == "128" || value == "all";
+#if !defined(__SIZEOF_INT128__)
+            options.benchmark128 = false;
+#endif
+            valid = options.benchmark32 || options.benchmark64 || options.benchmark128;
+        }
+        else if (name == "--filter") {
+            try {
+                options.filter.emplace(std::string(value));
+            }
+            catch (std::regex_error const& ex) {
+                std::cerr << "Invalid regex for --filter: " << ex.what() << "\n";
+                return false;
+            }
+        }
+        else if (name == "--samples") {
+            valid = parse_unsigned(value, config.number_of_samples) && config.number_of_samples != 0;
+        }
+        else if (name == "--min-digits") {
+            valid = parse_unsigned(value, config.min_digits);
+        }
+        else if (name == "--max-digits") {
+            std::size_t max_digits;
+            valid = parse_unsigned(value, max_digits);
+            options.max_digits = max_digits;
+        }
+        else if (name == "--distribution") {
+            config.distribution = {};
+            if (value == "uniform-digits-and-zeros") {
+                config.distribution.kind = sample_distribution_kind::uniform_digits_and_zeros;
+            }
+            else if (value == "uniform") {
+                config.distribution.kind = sample_distribution_kind::uniform;
+            }
+            else if (value.starts_with("fixed-zeros:")) {
+                config.distribution.kind = sample_distribution_kind::fixed_trailing_zeros;
+                valid = parse_unsigned(value.substr(std::string_view{"fixed-zeros:"}.size()),
+                                       config.distribution.number_of_trailing_zeros);
+            }
+            else if (value.starts_with("histogram:")) {
+                config.distribution.kind = sample_distribution_kind::histogram;
+                auto const path = std::string(value.substr(std::string_view{"histogram:"}.size()));
+                std::ifstream file{path};
+                if (!file || !read_histogram(file, config.distribution.histogram)) {
+                    std::cerr << "Failed to read the histogram from " << path << "\n";
+                    return false;
+                }
+            }
+            else if (value == "dragonbox") {
+                config.distribution.kind = sample_distribution_kind::dragonbox_realistic;
+            }
+            else {
+                valid = false;
+            }
+        }
+        else if (name == "--duration") {
+            std::chrono::milliseconds::rep duration = 0;
+            valid = parse_unsigned(value, duration);
+            config.min_duration_per_alg = std::chrono::milliseconds{duration};
+            duration_given = true;
+        }
+        else if (name == "--repetitions") {
+            valid = parse_unsigned(value, config.repetitions) && config.repetitions != 0;
+            repetitions_given = true;
+        }
+        else if (name == "--schedule") {
+            valid = value == "sequential" || value == "interleaved";
+            config.schedule =
+                value == "sequential" ? schedule_mode::sequential : schedule_mode::interleaved;
+        }
+        else if (name == "--target-ci") {
+            auto const last = value.data() + value.size();
+            double percent;
+            auto const result = std::from_chars(value.data(), last, percent);
+            valid = result.ec == std::errc{} && result.ptr == last && percent > 0;
+            config.target_relative_ci = percent / 100;
+        }
+        else if (name == "--max-duration") {
+            std::chrono::milliseconds::rep duration = 0;
+            valid = parse_unsigned(value, duration);
+            config.max_duration_per_alg = std::chrono::milliseconds{duration};
+        }
+        else if (name == "--warmup") {
+            valid = parse_unsigned(value, config.warmup_runs);
+            warmup_given = true;
+        }
+        else if (name == "--seed") {
+            std::uint64_t seed;
+            valid = parse_unsigned(value, seed);
+            config.seed = seed;
+        }
+        else if (name == "--dispatch") {
+            valid = value == "inlined" || value == "function-pointer";
+            config.dispatch =
+                value == "inlined" ? dispatch_mode::inlined : dispatch_mode::function_pointer;
+        }
+        else if (name == "--measure") {
+            valid = value == "throughput" || value == "latency" || value == "both";
+            config.measurement = value == "throughput" ? measurement_mode::throughput
+                                 : value == "latency"  ? measurement_mode::latency
+                                                       : measurement_mode::both;
+        }
+        else if (name == "--perf-counters") {
+            config.hardware_counters = true;
+        }
+        else if (name == "--timer") {
+            valid = value == "counter" || value == "steady-clock";
+            options.timer = value == "counter" ? timer_source::counter : timer_source::steady_clock;
+        }
+        else if (name == "--no-subtract-baseline") {
+            config.subtract_baseline = false;
+        }
+        else if (name == "--cpus") {
+            valid = parse_cpu_list(value, config.cpus);
+        }
+        else if (name == "--l1-cold") {
+            config.l1_cold_block_size = 16;
+            valid = value.empty() || (parse_unsigned(value, config.l1_cold_block_size) &&
+                                      config.l1_cold_block_size != 0);
+        }
+        else if (name == "--cold-calls") {
+            valid = parse_cold_call_config(value, config.cold_calls);
+        }
+        else if (name == "--pipeline") {
+            options.pipeline = true;
+        }
+        else if (name == "--digit-count") {
+            options.digit_count = true;
+        }
+        else if (name == "--entropy-sweep") {
+            options.entropy_sweep = true;
+        }
+        else if (name == "--sweep-data") {
+            options.sweep_data_path = value;
+            valid = !value.empty();
+        }
+        else if (name == "--bulk") {
+            options.bulk = true;
+        }
+        else if (name == "--bulk-size") {
+            valid = parse_unsigned(value, options.bulk_size_in_mib) && options.bulk_size_in_mib != 0;
+        }
+        else if (name == "--calibrate-dispatch") {
+            options.calibrate_dispatch = true;
+        }
+        else if (name == "--input") {
+            config.input_path = value;
+            valid = !value.empty();
+        }
+        else if (name == "--input-format") {
+            valid = false;
+            for (auto const format :
+                 {sample_file_format::binary, sample_file_format::text,
+                  sample_file_format::binary_float, sample_file_format::binary_double}) {
+                if (value == name_of(format)) {
+                    config.input_format = format;
+                    valid = true;
+                }
+            }
+        }
+        else if (name == "--csv") {
+            options.csv_path = value;
+            valid = !value.empty();
+        }
+        else if (name == "--json") {
+            options.json_path = value;
+            valid = !value.empty();
+        }
+        else if (name == "--list-kernels") {
+            options.list_kernels = true;
+        }
+        else if (name == "--merge") {
+            options.merge_paths.clear();
+            for (std::size_t first = 0; first <= value.size();) {
+                auto const last = std::min(value.find(',', first), value.size());
+                options.merge_paths.emplace_back(value.substr(first, last - first));
+                first = last + 1;
+            }
+            valid = std::none_of(options.merge_paths.cbegin(), options.merge_paths.cend(),
+                                 [](auto const& path) { return path.empty(); });
+        }
+        else if (name == "--compare") {
+            options.baseline_path = value;
+            valid = !value.empty();
+        }
+        else if (name == "--verify") {
+            valid = value.empty() || value == "full" || value == "edges";
+            options.verification =
+                value == "edges" ? verification_mode::edges : verification_mode::full;
+        }
+        else if (name == "--search-schedules") {
+            options.search_schedules = true;
+        }
+        else if (name == "--threshold") {
+            auto const last = value.data() + value.size();
+            auto const result =
+                std::from_chars(value.data(), last, options.regression_threshold_percent);
+            valid = result.ec == std::errc{} && result.ptr == last &&
+                    options.regression_threshold_percent >= 0;
+        }
+        else {
+            std::cerr << "Unknown option " << name << "\n\n" << usage;
+            return false;
+        }
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << arg << "\n\n" << usage;
+            return false;
+        }
+    }
+    // Adaptive stopping and interleaving take many short measurements instead of a few long ones.
+    if (options.config.schedule == schedule_mode::interleaved && !repetitions_given) {
+        options.config.repetitions = 10;
+    }
+    if (options.config.target_relative_ci || options.config.schedule == schedule_mode::interleaved) {
+        if (!duration_given) {
+            options.config.min_duration_per_alg = std::chrono::milliseconds{50};
+        }
+    }
+    // The sweep measures every candidate on a dozen workloads.
+    else if (options.entropy_sweep && !duration_given) {
+        options.config.min_duration_per_alg = std::chrono::milliseconds{100};
+    }
+    // Every measurement of the bulk benchmark is a single pass over the array.
+    if (options.bulk && !repetitions_given) {
+        options.config.repetitions = 5;
+    }
+    if (options.config.target_relative_ci && !warmup_given) {
+        options.config.warmup_runs = 1;
+    }
+    // There are no generated 128-bit kernels, so the schedule search skips 128-bit unless it is
+    // the only one requested.
+    if (options.search_schedules && (options.benchmark32 || options.benchmark64)) {
+        options.benchmark128 = false;
+    }
+    // Samples of every requested width must be able to have --max-digits digits, as
+    // check_sample_distribution requires.
+    if (options.max_digits) {
+        auto const max_digits = *options.max_digits;
+        auto const supports = [max_digits](bool requested, std::size_t digits10) {
+            return !requested || max_digits <= digits10;
+        };
+        auto valid = max_digits != 0 &&
+                     supports(options.benchmark32, std::numeric_limits<std::uint32_t>::digits10) &&
+                     supports(options.benchmark64, std::numeric_limits<std::uint64_t>::digits10);
+#if defined(__SIZEOF_INT128__)
+        valid = valid && supports(options.benchmark128,
+                                  std::numeric_limits<wuint::builtin_uint128_t>::digits10);
+#endif
+        if (!valid) {
+            std::cerr << "Invalid argument --max-digits=" << max_digits << "\n\n" << usage;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The largest number with at most max_digits digits that fits into T.
+template <class T>
+T max_value_with_digits(std::size_t max_digits) {
+    return max_digits > std::size_t(std::numeric_limits<T>::digits10)
+               ? std::numeric_limits<T>::max()
+               : T(compute_power(T(10), max_digits) - 1);
+}
+
+// Removes and reports the candidates that do not support every input up to max_value, which
+// would not even terminate on some of them. The baseline and the reference are kept. Returns
+// false if the reference does not support all of them either.
+template <class T>
+bool drop_candidates_outside_domain(std::vector<benchmark_candidate<T>>& benchmark_candidates,
+                                    T max_value) {
+    if (benchmark_candidates[1].max_input < max_value) {
+        std::cout << "Error: the " << std::numeric_limits<T>::digits << "-bit reference "
+                  << benchmark_candidates[1].name << " only supports inputs up to "
+                  << benchmark_candidates[1].max_input << ".\n";
+        return false;
+    }
+    auto const outside = std::remove_if(
+        benchmark_candidates.begin() + 2, benchmark_candidates.end(), [&](auto const& candidate) {
+            if (candidate.max_input >= max_value) {
+                return false;
+            }
+            std::cout << "Skipping the " << std::numeric_limits<T>::digits << "-bit candidate "
+                      << candidate.name << ", which only supports inputs up to "
+                      << candidate.max_input << ".\n";
+            return true;
+        });
+    if (outside != benchmark_candidates.end()) {
+        benchmark_candidates.erase(outside, benchmark_candidates.end());
+        std::cout << "\n";
+    }
+    return true;
+}
+
+// The candidates to verify or benchmark, or an empty list if the options ask for a schedule
+// search with more digits than any generated kernel supports. Unless verifying, where each
+// candidate is only checked within its domain, the candidates not supporting every number with
+// at most --max-digits digits are left out.
+template <class T>
+std::vector<benchmark_candidate<T>>
+make_benchmark_candidates(command_line_options const& options, std::size_t default_max_digits) {
+    auto const max_digits = options.max_digits.value_or(default_max_digits);
+    std::vector<benchmark_candidate<T>> benchmark_candidates;
+    if (!options.search_schedules) {
+        if constexpr (std::is_same_v<T, std::uint32_t>) {
+            benchmark_candidates = make_benchmark_candidates32();
+            append_bounded_candidates(benchmark_candidates, max_digits);
+        }
+        else if constexpr (std::is_same_v<T, std::uint64_t>) {
+            benchmark_candidates = make_benchmark_candidates64();
+            append_bounded_candidates(benchmark_candidates, max_digits);
+        }
+#if defined(__SIZEOF_INT128__)
+        else {
+            benchmark_candidates = make_benchmark_candidates128();
+        }
+#endif
+    }
+    else {
+        benchmark_candidates = make_schedule_search_candidates<T>(max_digits);
+        if (benchmark_candidates.empty()) {
+            std::cerr << "--search-schedules does not support " << std::numeric_limits<T>::digits
+                      << "-bit numbers with " << max_digits << " digits.\n";
+            return {};
+        }
+    }
+    if (!options.verification &&
+        !drop_candidates_outside_domain(benchmark_candidates, max_value_with_digits<T>(max_digits))) {
+        return {};
+    }
+    return benchmark_candidates;
+}
+
+// Without --max-digits, every input or edge case goes up to the largest value of T, each
+// candidate being checked within its domain, while the samples of a file only go up to
+// default_max_digits digits.
+template <class T>
+bool run_verification(command_line_options const& options, std::size_t default_max_digits) {
+    auto benchmark_candidates = make_benchmark_candidates<T>(options, default_max_digits);
+    if (benchmark_candidates.empty()) {
+        return false;
+    }
+    auto const& config = options.config;
+    auto const max_digits = options.max_digits.value_or(
+        config.input_path.empty() ? std::size_t(std::numeric_limits<T>::digits10) + 1
+                                  : default_max_digits);
+    auto const max_value = max_value_with_digits<T>(max_digits);
+
+    std::cout << "[" << std::numeric_limits<T>::digits << "-bit verification]\n\n";
+    if (options.filter) {
+        for (auto& candidate : benchmark_candidates) {
+            candidate.selected = std::regex_search(candidate.name, *options.filter);
+        }
+    }
+    if (config.input_path.empty()) {
+        return verify(benchmark_candidates, *options.verification, max_value, config.cpus);
+    }
+
+    if (auto const error =
+            check_sample_distribution<T>(sample_distribution{}, config.min_digits, max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+    sample_file_reader<T> reader{config.input_path, config.input_format, config.min_digits,
+                                 max_digits, config.number_of_samples};
+    if (!reader.is_open()) {
+        std::cout << "Error: failed to open " << config.input_path << ".\n";
+        return false;
+    }
+    return verify(benchmark_candidates, *options.verification, max_value, config.cpus, &reader);
+}
+
+// Reference point for the addresses printed by --list-kernels, found by its unmangled name in
+// the symbol table.
+extern "C" void rtz_benchmark_kernel_address_anchor() noexcept {}
+
+// Prints a line per candidate with the bits, the address of its kernel relative to
+// rtz_benchmark_kernel_address_anchor in hexadecimal, and its name, separated by tabs. The
+// distance between two functions is the same in the symbol table of the executable as at run
+// time, so cmake/codegen-report.cmake finds the symbol of each kernel regardless of where the
+// executable is loaded. For the Dispatched candidate, this is the kernel selected from CPUID that
+// dispatch::remove_trailing_zeros64 jumps to, not the jump itself.
+template <class T>
+bool list_kernels(command_line_options const& options, std::size_t default_max_digits) {
+    auto const benchmark_candidates = make_benchmark_candidates<T>(options, default_max_digits);
+    auto const anchor = reinterpret_cast<std::uintptr_t>(&rtz_benchmark_kernel_address_anchor);
+    for (auto const& candidate : benchmark_candidates) {
+        if (options.filter && !std::regex_search(candidate.name, *options.filter)) {
+            continue;
+        }
+        auto kernel = candidate.candidate_function;
+        if constexpr (std::is_same_v<T, std::uint64_t>) {
+            if (kernel == &dispatch::remove_trailing_zeros64) {
+                kernel = dispatch::selected_variant64().kernel;
+            }
+        }
+        auto const address = kernel != nullptr
+                                 ? reinterpret_cast<std::uintptr_t>(kernel)
+                                 : reinterpret_cast<std::uintptr_t>(candidate.batch_candidate_function);
+        std::cout << std::numeric_limits<T>::digits << "\t" << (address < anchor ? "-" : "")
+                  << "0x" << std::hex << (address < anchor ? anchor - address : address - anchor)
+                  << std::dec << "\t" << candidate.name << "\n";
+    }
+    return !benchmark_candidates.empty();
+}
+
+constexpr std::size_t number_of_dispatch_calibration_samples = 10000;
+constexpr std::size_t number_of_dispatch_calibration_repetitions = 3;
+constexpr std::chrono::milliseconds dispatch_calibration_duration{20};
+
+// Times every variant of dispatch::variants64 supported by the CPU through the dispatched path,
+// on samples drawn like the benchmarked ones, and selects the fastest. The CPUID choice is kept if
+// the samples cannot be generated.
+void calibrate_dispatch64(benchmark_config const& config) {
+    if (!check_sample_distribution<std::uint64_t>(config.distribution, config.min_digits,
+                                                  config.max_digits)
+             .empty()) {
+        return;
+    }
+    auto const samples = generate_random_samples<std::uint64_t>(
+        number_of_dispatch_calibration_samples, config.min_digits, config.max_digits,
+        config.distribution, config.seed ? *config.seed : generate_random_seed());
+    auto const features = dispatch::detect_cpu_features();
+
+    std::cout << "Calibrating the dispatched kernel, in ns per sample (best of "
+              << number_of_dispatch_calibration_repetitions << "):\n";
+    std::optional<std::size_t> fastest_idx;
+    double fastest_time = 0;
+    for (std::size_t idx = 0; idx < std::size(dispatch::variants64); ++idx) {
+        auto const& variant = dispatch::variants64[idx];
+        if (!dispatch::is_supported(variant, features)) {
+            continue;
+        }
+        dispatch::use_variant64(idx);
+        auto time = std::numeric_limits<double>::infinity();
+        for (std::size_t repetition = 0; repetition < number_of_dispatch_calibration_repetitions;
+             ++repetition) {
+            time = std::min(time, measure_average_time_in_nanoseconds(
+                                      [&] {
+                                          run_inlined_loop<dispatch::remove_trailing_zeros64>(
+                                              std::span<std::uint64_t const>{samples});
+                                      },
+                                      samples.size(), dispatch_calibration_duration));
+        }
+        std::cout << std::setw(50) << variant.name << std::setw(10) << time << "\n";
+        if (!fastest_idx || time < fastest_time) {
+            fastest_idx = idx;
+            fastest_time = time;
+        }
+    }
+    if (fastest_idx) {
+        dispatch::use_variant64(*fastest_idx);
+    }
+}
+
+template <class T>
+bool run_benchmark(command_line_options const& options, std::size_t default_max_digits,
+                   std::vector<result_record>& records) {
+    auto benchmark_candidates = make_benchmark_candidates<T>(options, default_max_digits);
+    if (benchmark_candidates.empty()) {
+        return false;
+    }
+    auto config = options.config;
+    config.max_digits = options.max_digits.value_or(default_max_digits);
+
+    std::cout << "[" << std::numeric_limits<T>::digits << "-bit benchmark for numbers with ";
+    if (config.min_digits == 1) {
+        std::cout << "at most " << config.max_digits << " digits]\n\n";
+    }
+    else {
+        std::cout << config.min_digits << " to " << config.max_digits << " digits]\n\n";
+    }
+
+    if (options.filter) {
+        for (auto& candidate : benchmark_candidates) {
+            candidate.selected = std::regex_search(candidate.name, *options.filter);
+        }
+    }
+    if (config.subtract_baseline) {
+        benchmark_candidates.front().selected = true;
+    }
+
+    if constexpr (std::is_same_v<T, std::uint64_t>) {
+        if (!options.search_schedules) {
+            if (options.calibrate_dispatch) {
+                calibrate_dispatch64(config);
             }
+            std::cout << "Dispatching to " << dispatch::selected_variant64().name
+                      << (options.calibrate_dispatch ? "" : " (from CPUID)") << ".\n\n";
         }
     }
 
+    if (!benchmark(benchmark_candidates, config)) {
+        return false;
+    }
+    print_results(benchmark_candidates, config);
+    if (options.search_schedules) {
+        print_schedule_ranking(benchmark_candidates, config.measurement);
+    }
+    std::cout << "\n\n";
+    append_result_records(benchmark_candidates, config, records);
+    return true;
+}
+
+// Numbers for the pipeline benchmark with the significands Dragonbox would produce for them.
+template <class T, class Float>
+struct pipeline_input {
+    std::vector<Float> numbers;
+    std::vector<pipeline_sample<T>> samples;
+
+    // Returns false if x has no significand with min_digits to max_digits digits.
+    bool add(Float x, std::size_t min_digits, std::size_t max_digits) {
+        auto const sample = make_pipeline_sample<T>(x, min_digits, max_digits);
+        if (sample) {
+            numbers.push_back(x);
+            samples.push_back(*sample);
+        }
+        return sample.has_value();
+    }
+};
+
+// Uniformly random bit patterns, like for the Dragonbox-realistic distribution.
+template <class T, class Float>
+pipeline_input<T, Float> generate_pipeline_input(benchmark_config const& config, std::uint64_t seed) {
+    using bits_type = std::conditional_t<sizeof(Float) == sizeof(float), std::uint32_t, std::uint64_t>;
+    pipeline_input<T, Float> input;
+    xoshiro256_plus_plus rg{seed};
+    std::uint64_t number_of_considered = 0;
+    std::uint64_t number_of_rejected = 0;
+    while (input.samples.size() < config.number_of_samples) {
+        auto const x = std::bit_cast<Float>(bits_type(rg()));
+        if (!std::isfinite(x) || x == 0) {
+            continue;
+        }
+        ++number_of_considered;
+        if (!input.add(x, config.min_digits, config.max_digits)) {
+            ++number_of_rejected;
+        }
+    }
+    print_dragonbox_rejection_rate(sizeof(Float) == sizeof(float) ? "float" : "double",
+                                   number_of_rejected, number_of_considered, config.min_digits,
+                                   config.max_digits);
+    return input;
+}
+
+// The first config.number_of_samples numbers of config.input_path with suitable significands.
+// Returns false after printing a message if the file could not be read.
+template <class T, class Float>
+bool read_pipeline_input(benchmark_config const& config, pipeline_input<T, Float>& input) {
+    std::ifstream file{config.input_path, std::ios::binary};
+    if (!file) {
+        std::cout << "Error: failed to open " << config.input_path << ".\n";
+        return false;
+    }
+    std::uint64_t number_of_skipped_numbers = 0;
+    Float x;
+    while (input.samples.size() < config.number_of_samples &&
+           file.read(reinterpret_cast<char*>(&x), sizeof(x))) {
+        if (!input.add(x, config.min_digits, config.max_digits)) {
+            ++number_of_skipped_numbers;
+        }
+    }
+    if (input.samples.empty()) {
+        std::cout << "Error: the file has no numbers with " << config.min_digits << " to "
+                  << config.max_digits << " significand digits.\n";
+        return false;
+    }
+    std::cout << input.samples.size() << " numbers read, " << number_of_skipped_numbers
+              << " skipped for being zero, not finite or out of range.\n";
+    return true;
+}
+
+template <class Float>
+void run_to_chars_loop(std::span<Float const> numbers, char* output) {
+    for (auto const x : numbers) {
+        output = std::to_chars(output, output + max_scientific_length, x).ptr;
+    }
+}
+
+// Times float-to-string conversion with each candidate removing the trailing zeros of the
+// significands. Writing a Dragonbox-style digit generation is out of scope, so the significands
+// are computed beforehand, and std::to_chars on the same numbers is timed as the end-to-end
+// reference. Every printed number is checked to read back as the original one.
+template <class T>
+bool run_pipeline_benchmark(command_line_options const& options, std::size_t default_max_digits,
+                            std::vector<result_record>& records) {
+    using float_type = std::conditional_t<sizeof(T) == sizeof(float), float, double>;
+    constexpr char const* float_name = sizeof(T) == sizeof(float) ? "float" : "double";
+    auto const expected_format = sizeof(T) == sizeof(float) ? sample_file_format::binary_float
+                                                            : sample_file_format::binary_double;
+
+    auto config = options.config;
+    config.max_digits = options.max_digits.value_or(default_max_digits);
+    if (!config.input_path.empty() && config.input_format != expected_format) {
+        std::cout << "[" << std::numeric_limits<T>::digits << "-bit pipeline benchmark skipped, "
+                  << "since the input file does not contain " << float_name << "s]\n\n\n";
+        return true;
+    }
+    auto benchmark_candidates = make_benchmark_candidates<T>(options, default_max_digits);
+    if (benchmark_candidates.empty()) {
+        return false;
+    }
+    std::cout << "[" << std::numeric_limits<T>::digits << "-bit pipeline benchmark for "
+              << float_name << "s with " << config.min_digits << " to " << config.max_digits
+              << " significand digits]\n\n";
+    if (options.filter) {
+        for (auto& candidate : benchmark_candidates) {
+            candidate.selected = std::regex_search(candidate.name, *options.filter);
+        }
+    }
+    if (auto const error =
+            check_sample_distribution<T>(sample_distribution{}, config.min_digits, config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+
+    pipeline_input<T, float_type> input;
+    if (config.input_path.empty()) {
+        auto const seed = config.seed ? *config.seed : generate_random_seed();
+        std::cout << "Generating random " << float_name << "s (seed " << seed << ")...\n";
+        input = generate_pipeline_input<T, float_type>(config, seed);
+    }
+    else if (!read_pipeline_input(config, input)) {
+        return false;
+    }
+    std::span<pipeline_sample<T> const> const samples{input.samples};
+    std::span<float_type const> const numbers{input.numbers};
+    std::vector<char> output(samples.size() * max_scientific_length);
+
+    std::cout << "Verifying candidate algorithms...\n";
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.selected || candidate.inlined_pipeline_loop == nullptr) {
+            continue;
+        }
+        for (std::size_t idx = 0; idx < samples.size(); ++idx) {
+            auto const& sample = samples[idx];
+            auto const result = (*candidate.candidate_function)(sample.significand);
+            auto const end = write_scientific(sample.negative, result.trimmed_number,
+                                              sample.exponent + int(result.number_of_removed_zeros),
+                                              output.data());
+            float_type read_back = 0;
+            std::from_chars(output.data(), end, read_back);
+            if (read_back != numbers[idx]) {
+                std::cout << "Error detected for the input " << numbers[idx] << "!\n";
+                std::cout << "    " << std::setw(37) << candidate.name << ": "
+                          << std::string_view(output.data(), std::size_t(end - output.data()))
+                          << "\n";
+                return false;
+            }
+        }
+    }
+
+    std::mt19937_64 bootstrap_rg;
     for (auto& candidate : benchmark_candidates) {
+        if (!candidate.selected || candidate.inlined_pipeline_loop == nullptr) {
+            continue;
+        }
         std::cout << "Benchmarking " << candidate.name << "...\n";
-        auto const start_time = std::chrono::steady_clock::now();
-        std::size_t run_count = 0;
-        while (true) {
-            for (auto const& sample : samples) {
-                auto volatile result = (*candidate.candidate_function)(sample);
-                static_cast<void>(result);
+        candidate.pipeline_measurements.clear();
+        if (!repeat_measurements(
+                config,
+                [&] {
+                    candidate.pipeline_measurements.push_back(measure_average_time_in_nanoseconds(
+                        [&] {
+                            if (config.dispatch == dispatch_mode::inlined) {
+                                (*candidate.inlined_pipeline_loop)(samples, output.data());
+                            }
+                            else {
+                                run_pipeline_loop(candidate.candidate_function, samples,
+                                                  output.data());
+                            }
+                        },
+                        samples.size(), config.min_duration_per_alg));
+                },
+                [&] { candidate.pipeline_measurements.clear(); }, {&candidate.pipeline_measurements},
+                bootstrap_rg)) {
+            std::cout << "Warning: stopped at the time limit before the 95% CI converged.\n";
+        }
+        candidate.pipeline_statistics =
+            compute_statistics(candidate.pipeline_measurements, bootstrap_rg);
+    }
+    std::cout << "Benchmarking std::to_chars...\n";
+    std::vector<double> reference_measurements;
+    if (!repeat_measurements(
+            config,
+            [&] {
+                reference_measurements.push_back(measure_average_time_in_nanoseconds(
+                    [&] { run_to_chars_loop(numbers, output.data()); }, samples.size(),
+                    config.min_duration_per_alg));
+            },
+            [&] { reference_measurements.clear(); }, {&reference_measurements}, bootstrap_rg)) {
+        std::cout << "Warning: stopped at the time limit before the 95% CI converged.\n";
+    }
+    auto const reference_statistics = compute_statistics(reference_measurements, bootstrap_rg);
+    std::cout << "Done.\n\n";
+
+    std::cout << "Trimming and printing the significands of " << samples.size() << " " << float_name
+              << "s, in ns per number (median):\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "median" << std::setw(14)
+              << "vs. to_chars\n";
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.pipeline_measurements.empty()) {
+            std::cout << std::setw(42) << candidate.name << std::setw(10)
+                      << candidate.pipeline_statistics.median << std::setw(13)
+                      << candidate.pipeline_statistics.median / reference_statistics.median * 100
+                      << "%\n";
+        }
+    }
+    std::cout << std::setw(42) << "std::to_chars (reference)" << std::setw(10)
+              << reference_statistics.median << "\n\n\n";
+
+    for (auto const& candidate : benchmark_candidates) {
+        if (!candidate.pipeline_measurements.empty()) {
+            records.push_back({std::size_t(std::numeric_limits<T>::digits), config.min_digits,
+                               config.max_digits, candidate.name, "pipeline",
+                               candidate.pipeline_measurements.size(), candidate.pipeline_statistics,
+                               std::nullopt});
+        }
+    }
+    records.push_back({std::size_t(std::numeric_limits<T>::digits), config.min_digits,
+                       config.max_digits, "std::to_chars (reference)", "pipeline",
+                       reference_measurements.size(), reference_statistics, std::nullopt});
+    return true;
+}
+
+// Trimming followed by counting the digits of the trimmed number, as callers do without the
+// *_count_digits kernels.
+template <auto kernel, class UInt = decltype(kernel(0).trimmed_number)>
+constexpr trim_and_count_digits_return<UInt> trim_then_count_digits(UInt n) noexcept {
+    auto const result = kernel(n);
+    return {result.trimmed_number, result.number_of_removed_zeros,
+            digit_count_detail::count_digits(result.trimmed_number)};
+}
+
+template <class T>
+void consume_result(trim_and_count_digits_return<T> const& result) noexcept {
+    consume_result(
+        remove_trailing_zeros_return<T>{result.trimmed_number, result.number_of_removed_zeros});
+    [[maybe_unused]] std::size_t volatile number_of_remaining_digits =
+        result.number_of_remaining_digits;
+}
+
+// One pass over the samples with function inlined. If dependent is set, every input depends on
+// the previous result as in run_dependent_loop.
+template <auto function, class T>
+RTZ_BENCHMARK_NO_SPLIT_PATHS void run_digit_count_loop(std::span<T const> samples, T zero,
+                                                       bool dependent) {
+    if (dependent) {
+        auto result = trim_and_count_digits_return<T>{0, 0, 0};
+        for (auto const& sample : samples) {
+            auto const dependency = T((result.trimmed_number + result.number_of_removed_zeros +
+                                       result.number_of_remaining_digits) &
+                                      zero);
+            result = function(T(sample | dependency));
+        }
+        consume_result(result);
+    }
+    else {
+        for (auto const& sample : samples) {
+            consume_result(function(sample));
+        }
+    }
+}
+
+template <class T>
+struct digit_count_variant {
+    trim_and_count_digits_return<T> (*function)(T) = nullptr;
+    void (*inlined_loop)(std::span<T const>, T, bool) = nullptr;
+};
+
+template <auto function>
+auto make_digit_count_variant() {
+    using sample_type = decltype(function(0).trimmed_number);
+    return digit_count_variant<sample_type>{function, run_digit_count_loop<function, sample_type>};
+}
+
+// A branchless kernel followed by a digit count of the trimmed number, and the same kernel alongside
+// a digit count of the input (its *_count_digits version).
+template <class T>
+struct digit_count_candidate {
+    std::string name;
+    digit_count_variant<T> after;
+    digit_count_variant<T> alongside;
+};
+
+template <auto kernel, auto counting_kernel>
+auto make_digit_count_candidate(std::string name) {
+    auto const after = make_digit_count_variant<trim_then_count_digits<kernel>>();
+    return digit_count_candidate<decltype(after.function(0).trimmed_number)>{
+        std::move(name), after, make_digit_count_variant<counting_kernel>()};
+}
+
+std::vector<digit_count_candidate<std::uint32_t>> make_digit_count_candidates32() {
+    using namespace alg32;
+    return {make_digit_count_candidate<naive_branchless, naive_branchless_count_digits>(
+                "Naive branchless"),
+            make_digit_count_candidate<granlund_montgomery_branchless,
+                                       granlund_montgomery_branchless_count_digits>(
+                "Granlund-Montgomery branchless"),
+            make_digit_count_candidate<lemire_branchless, lemire_branchless_count_digits>(
+                "Lemire branchless"),
+            make_digit_count_candidate<generalized_granlund_montgomery_branchless,
+                                       generalized_granlund_montgomery_branchless_count_digits>(
+                "Generalized Granlund-Montgomery branchless")};
+}
+
+std::vector<digit_count_candidate<std::uint64_t>> make_digit_count_candidates64() {
+    using namespace alg64;
+    return {make_digit_count_candidate<naive_branchless, naive_branchless_count_digits>(
+                "Naive branchless"),
+            make_digit_count_candidate<granlund_montgomery_branchless,
+                                       granlund_montgomery_branchless_count_digits>(
+                "Granlund-Montgomery branchless"),
+            make_digit_count_candidate<lemire_branchless, lemire_branchless_count_digits>(
+                "Lemire branchless"),
+            make_digit_count_candidate<generalized_granlund_montgomery_branchless,
+                                       generalized_granlund_montgomery_branchless_count_digits>(
+                "Generalized Granlund-Montgomery branchless")};
+}
+
+// Times the *_count_digits kernels, which count the digits of the input alongside the kernel, against
+// trimming followed by a digit count of the trimmed number.
+template <class T>
+bool run_digit_count_benchmark(command_line_options const& options, std::size_t default_max_digits,
+                               std::vector<result_record>& records) {
+    auto config = options.config;
+    config.max_digits = options.max_digits.value_or(default_max_digits);
+    auto candidates = [] {
+        if constexpr (std::is_same_v<T, std::uint32_t>) {
+            return make_digit_count_candidates32();
+        }
+        else {
+            return make_digit_count_candidates64();
+        }
+    }();
+    if (options.filter) {
+        std::erase_if(candidates, [&](digit_count_candidate<T> const& candidate) {
+            return !std::regex_search(candidate.name, *options.filter);
+        });
+    }
+    std::cout << "[" << std::numeric_limits<T>::digits
+              << "-bit digit count benchmark for numbers with " << config.min_digits << " to "
+              << config.max_digits << " digits]\n\n";
+    if (auto const error = check_sample_distribution<T>(config.distribution, config.min_digits,
+                                                        config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+
+    auto const seed = config.seed ? *config.seed : generate_random_seed();
+    std::cout << "Generating samples (" << describe(config.distribution) << ", seed " << seed
+              << ")...\n";
+    print_sample_distribution_notes<T>(config.distribution, config.min_digits, config.max_digits);
+    auto const samples = generate_random_samples<T>(config.number_of_samples, config.min_digits,
+                                                    config.max_digits, config.distribution, seed);
+
+    std::cout << "Verifying candidate algorithms...\n";
+    auto const reference_function = [] {
+        if constexpr (std::is_same_v<T, std::uint32_t>) {
+            return trim_then_count_digits<alg32::naive>;
+        }
+        else {
+            return trim_then_count_digits<alg64::naive>;
+        }
+    }();
+    for (auto const sample : samples) {
+        auto const reference_result = reference_function(sample);
+        for (auto const& candidate : candidates) {
+            for (auto const* variant : {&candidate.after, &candidate.alongside}) {
+                if ((*variant->function)(sample) != reference_result) {
+                    std::cout << "Error detected for the input " << sample << " in "
+                              << candidate.name << "!\n";
+                    return false;
+                }
             }
-            auto const duration = std::chrono::steady_clock::now() - start_time;
-            ++run_count;
+        }
+    }
 
-            if (duration >= min_duration_per_alg) {
-                candidate.average_time_in_nanoseconds =
-                    double(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
-                    (double(run_count) * number_of_samples);
-                break;
+    // Read through a volatile so that the compiler cannot see it is zero.
+    T volatile opaque_zero = 0;
+    std::mt19937_64 bootstrap_rg;
+    auto const measure = [&](digit_count_variant<T> const& variant, bool dependent) {
+        std::vector<double> measurements;
+        T const zero = opaque_zero;
+        // Not converging is not reported, since the row is printed as it is measured.
+        repeat_measurements(
+            config,
+            [&] {
+                measurements.push_back(measure_average_time_in_nanoseconds(
+                    [&] { (*variant.inlined_loop)(samples, zero, dependent); }, samples.size(),
+                    config.min_duration_per_alg));
+            },
+            [&] { measurements.clear(); }, {&measurements}, bootstrap_rg);
+        return std::pair{measurements.size(), compute_statistics(measurements, bootstrap_rg)};
+    };
+
+    std::cout << "Trimming and counting digits, in ns per sample (median):\n";
+    std::cout << std::setw(42) << "" << std::setw(20) << "throughput" << std::setw(20) << "latency"
+              << "\n";
+    std::cout << std::setw(42) << "" << std::setw(10) << "after" << std::setw(10) << "alongside"
+              << std::setw(10) << "after" << std::setw(10) << "alongside"
+              << "\n";
+    for (auto const& candidate : candidates) {
+        std::cout << std::setw(42) << candidate.name;
+        for (auto const dependent : {false, true}) {
+            if (config.measurement == (dependent ? measurement_mode::throughput
+                                                 : measurement_mode::latency)) {
+                std::cout << std::setw(20) << "";
+                continue;
+            }
+            for (auto const alongside : {false, true}) {
+                auto const [repetitions, statistics] =
+                    measure(alongside ? candidate.alongside : candidate.after, dependent);
+                std::cout << std::setw(10) << statistics.median << std::flush;
+                records.push_back({std::size_t(std::numeric_limits<T>::digits), config.min_digits,
+                                   config.max_digits,
+                                   candidate.name + (alongside ? " + digit count" : ", then digit count"),
+                                   dependent ? "latency" : "throughput", repetitions, statistics,
+                                   std::nullopt});
             }
         }
+        std::cout << "\n";
     }
-    std::cout << "Done.\n\n";
+    std::cout << "\n\n";
+    return true;
 }
 
-int main() {
-    constexpr bool benchmark32 = true;
-    constexpr bool benchmark64 = true;
-
-    if constexpr (benchmark32) {
-        std::cout << "[32-bit benchmark for numbers with at most 8 digits]\n\n";
-
-        std::vector<benchmark_candidate<std::uint32_t>> benchmark_candidates = {
-            {"Null (baseline)", alg32::baseline},                                                //
-            {"Naive", alg32::naive},                                                             //
-            {"Granlund-Montgomery", alg32::granlund_montgomery},                                 //
-            {"Lemire", alg32::lemire},                                                           //
-            {"Generalized Granlund-Montgomery", alg32::generalized_granlund_montgomery},         //
-            {"Naive 2-1", alg32::naive_2_1},                                                     //
-            {"Granlund-Montgomery 2-1", alg32::granlund_montgomery_2_1},                         //
-            {"Lemire 2-1", alg32::lemire_2_1},                                                   //
-            {"Generalized Granlund-Montgomery 2-1", alg32::generalized_granlund_montgomery_2_1}, //
-            {"Naive branchless", alg32::naive_branchless},                                       //
-            {"Granlund-Montgomery branchless", alg32::granlund_montgomery_branchless},           //
-            {"Lemire branchless", alg32::lemire_branchless},                                     //
-            {"Generalized Granlund-Montgomery branchless",
-             alg32::generalized_granlund_montgomery_branchless} //
-        };
+// One workload of the branch-predictability sweep: every sample has the maximum number of
+// digits, so only the sequence of the numbers of trailing zeros differs between workloads.
+struct sweep_workload {
+    // Short enough to be a column header.
+    std::string label;
+    std::string description;
+    // Shannon entropy of the number of trailing zeros of one sample, and what is left of it given
+    // all the previous samples, i.e. zero for the deterministic sequences, in bits.
+    double distribution_entropy = 0;
+    double entropy_rate = 0;
+    std::vector<std::size_t> numbers_of_trailing_zeros;
+};
 
-        benchmark(benchmark_candidates, 100000, 8, std::chrono::milliseconds(1500));
-        for (auto const& candidate : benchmark_candidates) {
-            std::cout << std::setw(42) << candidate.name << ": "
-                      << candidate.average_time_in_nanoseconds << "ns\n";
+// Entropy in bits of no trailing zeros with probability 1 - q, and of a uniformly random number
+// of them below number_of_counts otherwise.
+double mixture_entropy(double q, std::size_t number_of_counts) {
+    auto const entropy_term = [](double p) { return p <= 0 ? 0 : -p * std::log2(p); };
+    auto const n = double(number_of_counts);
+    return entropy_term(1 - q + q / n) + (n - 1) * entropy_term(q / n);
+}
+
+// Entropy in bits of the frequencies of the counts in numbers_of_trailing_zeros.
+double empirical_entropy(std::span<std::size_t const> numbers_of_trailing_zeros,
+                         std::size_t number_of_counts) {
+    std::vector<std::size_t> frequencies(number_of_counts);
+    for (auto const count : numbers_of_trailing_zeros) {
+        ++frequencies[count];
+    }
+    double entropy = 0;
+    for (auto const frequency : frequencies) {
+        if (frequency != 0) {
+            auto const p = double(frequency) / double(numbers_of_trailing_zeros.size());
+            entropy -= p * std::log2(p);
         }
-        std::cout << "\n\n";
     }
+    return entropy;
+}
 
-    if constexpr (benchmark64) {
-        std::cout << "[64-bit benchmark for numbers with at most 16 digits]\n\n";
-
-        std::vector<benchmark_candidate<std::uint64_t>> benchmark_candidates = {
-            {"Null (baseline)", alg64::baseline},                                                    //
-            {"Naive", alg64::naive},                                                                 //
-            {"Granlund-Montgomery", alg64::granlund_montgomery},                                     //
-            {"Lemire", alg64::lemire},                                                               //
-            {"Generalized Granlund-Montgomery", alg64::generalized_granlund_montgomery},             //
-            {"Naive 2-1", alg64::naive_2_1},                                                         //
-            {"Granlund-Montgomery 2-1", alg64::granlund_montgomery_2_1},                             //
-            {"Lemire 2-1", alg64::lemire_2_1},                                                       //
-            {"Generalized Granlund-Montgomery 2-1", alg64::generalized_granlund_montgomery_2_1},     //
-            {"Naive 8-2-1", alg64::naive_8_2_1},                                                     //
-            {"Granlund-Montgomery 8-2-1", alg64::granlund_montgomery_8_2_1},                         //
-            {"Lemire 8-2-1", alg64::lemire_8_2_1},                                                   //
-            {"Generalized Granlund-Montgomery 8-2-1", alg64::generalized_granlund_montgomery_8_2_1}, //
-            {"Naive branchless", alg64::naive_branchless},                                           //
-            {"Granlund-Montgomery branchless", alg64::granlund_montgomery_branchless},               //
-            {"Lemire branchless", alg64::lemire_branchless},                                         //
-            {"Generalized Granlund-Montgomery branchless",
-             alg64::generalized_granlund_montgomery_branchless} //
-        };
+// From predictable to random: a constant count, uniformly random counts sorted, a random
+// pattern of uniformly random counts repeated with growing periods that outgrow the history of
+// the branch predictor, then independent counts of growing entropy, ending with uniform ones.
+std::vector<sweep_workload> make_sweep_workloads(std::size_t number_of_samples,
+                                                 std::size_t max_trailing_zeros,
+                                                 std::uint64_t seed) {
+    auto const number_of_counts = max_trailing_zeros + 1;
+    auto const max_entropy = std::log2(double(number_of_counts));
+    xoshiro256_plus_plus rg{seed, 1};
+    auto const uniform_count = [&] {
+        return generate_uniform_integer(std::size_t(0), max_trailing_zeros, rg);
+    };
+    std::vector<sweep_workload> workloads;
 
-        benchmark(benchmark_candidates, 100000, 16, std::chrono::milliseconds(1500));
-        for (auto const& candidate : benchmark_candidates) {
-            std::cout << std::setw(42) << candidate.name << ": "
-                      << candidate.average_time_in_nanoseconds << "ns\n";
+    auto& constant = workloads.emplace_back();
+    constant.label = "const";
+    constant.description = "no trailing zeros";
+    constant.numbers_of_trailing_zeros.assign(number_of_samples, 0);
+
+    auto& sorted = workloads.emplace_back();
+    sorted.label = "sorted";
+    sorted.description = "uniform, sorted";
+    for (std::size_t idx = 0; idx < number_of_samples; ++idx) {
+        sorted.numbers_of_trailing_zeros.push_back(uniform_count());
+    }
+    std::sort(sorted.numbers_of_trailing_zeros.begin(), sorted.numbers_of_trailing_zeros.end());
+    sorted.distribution_entropy =
+        empirical_entropy(sorted.numbers_of_trailing_zeros, number_of_counts);
+
+    for (std::size_t const period : {4, 16, 64, 256, 1024}) {
+        auto& periodic = workloads.emplace_back();
+        periodic.label = "p" + std::to_string(period);
+        periodic.description = "uniform, repeated every " + std::to_string(period) + " samples";
+        std::vector<std::size_t> pattern(period);
+        for (auto& count : pattern) {
+            count = uniform_count();
+        }
+        // Short patterns cannot contain every count.
+        periodic.distribution_entropy = empirical_entropy(pattern, number_of_counts);
+        for (std::size_t idx = 0; idx < number_of_samples; ++idx) {
+            periodic.numbers_of_trailing_zeros.push_back(pattern[idx % period]);
+        }
+    }
+
+    std::vector<double> target_entropies;
+    for (double const target_entropy : {0.25, 0.5, 1.0, 2.0, 3.0, 4.0, 5.0}) {
+        if (target_entropy < max_entropy - 0.01) {
+            target_entropies.push_back(target_entropy);
+        }
+    }
+    target_entropies.push_back(max_entropy);
+    for (auto const target_entropy : target_entropies) {
+        // The entropy grows with q, so bisect for the target.
+        double lower = 0, upper = 1;
+        for (int iteration = 0; iteration < 60; ++iteration) {
+            auto const middle = (lower + upper) / 2;
+            (mixture_entropy(middle, number_of_counts) < target_entropy ? lower : upper) = middle;
+        }
+        auto const q = target_entropy == max_entropy ? 1.0 : (lower + upper) / 2;
+
+        auto& random = workloads.emplace_back();
+        std::ostringstream label;
+        label << "H" << std::setprecision(3) << target_entropy;
+        random.label = label.str();
+        random.description = target_entropy == max_entropy
+                                 ? std::string{"uniform, independent"}
+                                 : "no zeros, or uniform with probability " + std::to_string(q);
+        random.distribution_entropy = mixture_entropy(q, number_of_counts);
+        random.entropy_rate = random.distribution_entropy;
+        for (std::size_t idx = 0; idx < number_of_samples; ++idx) {
+            auto const draw = double(rg() >> 11) * 0x1.0p-53;
+            random.numbers_of_trailing_zeros.push_back(draw < q ? uniform_count() : 0);
+        }
+    }
+    return workloads;
+}
+
+// Times the selected candidates on every workload of make_sweep_workloads, prints a table of
+// the medians with the fastest candidate per workload, and appends them to plot_data, if given,
+// as one gnuplot data block per metric, with a row per workload and a column per candidate.
+template <class T>
+bool run_entropy_sweep(command_line_options const& options, std::size_t default_max_digits,
+                       std::vector<result_record>& records, std::ostream* plot_data) {
+    auto benchmark_candidates = make_benchmark_candidates<T>(options, default_max_digits);
+    if (benchmark_candidates.empty()) {
+        return false;
+    }
+    auto config = options.config;
+    config.max_digits = options.max_digits.value_or(default_max_digits);
+    if (auto const error =
+            check_sample_distribution<T>(sample_distribution{}, config.min_digits, config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+    if (options.filter) {
+        for (auto& candidate : benchmark_candidates) {
+            candidate.selected = std::regex_search(candidate.name, *options.filter);
+        }
+    }
+    std::cout << "[" << std::numeric_limits<T>::digits
+              << "-bit branch-predictability sweep for numbers with " << config.max_digits
+              << " digits]\n\n";
+
+    auto const seed = config.seed ? *config.seed : generate_random_seed();
+    std::cout << "Generating samples (seed " << seed << ")...\n";
+    auto workloads = make_sweep_workloads(config.number_of_samples, config.max_digits - 1, seed);
+    std::vector<std::vector<T>> samples_per_workload;
+    xoshiro256_plus_plus rg{seed};
+    for (auto const& workload : workloads) {
+        auto& samples = samples_per_workload.emplace_back();
+        for (auto const number_of_trailing_zeros : workload.numbers_of_trailing_zeros) {
+            samples.push_back(
+                generate_sample<T>(config.max_digits, number_of_trailing_zeros, true, rg));
+        }
+        if (!check_candidates_on_samples(benchmark_candidates, std::span<T const>{samples})) {
+            return false;
+        }
+    }
+
+    std::vector<T> trimmed_numbers(config.number_of_samples);
+    std::vector<std::size_t> numbers_of_removed_zeros(config.number_of_samples);
+    // Read through a volatile so that the compiler cannot see it is zero.
+    T volatile opaque_zero = 0;
+    std::mt19937_64 bootstrap_rg;
+
+    std::cout << "Workloads:\n";
+    for (auto const& workload : workloads) {
+        std::cout << std::setw(8) << workload.label << ": " << workload.description << " (entropy "
+                  << workload.distribution_entropy << " bits, " << workload.entropy_rate
+                  << " given the previous samples)\n";
+    }
+    std::cout << "\n";
+
+    for (auto const latency : {false, true}) {
+        if (config.measurement ==
+            (latency ? measurement_mode::throughput : measurement_mode::latency)) {
+            continue;
+        }
+        char const* const metric = latency ? "latency" : "throughput";
+        std::cout << (latency ? "Latency" : "Throughput") << " in ns per sample (median):\n";
+        std::cout << std::setw(42) << "";
+        for (auto const& workload : workloads) {
+            std::cout << std::setw(10) << workload.label;
+        }
+        std::cout << "\n";
+
+        // medians[candidate][workload], empty for unmeasured candidates.
+        std::vector<std::vector<double>> medians(benchmark_candidates.size());
+        for (std::size_t candidate_idx = 0; candidate_idx < benchmark_candidates.size();
+             ++candidate_idx) {
+            auto const& candidate = benchmark_candidates[candidate_idx];
+            if (!candidate.selected || (latency && candidate.batch_candidate_function != nullptr)) {
+                continue;
+            }
+            std::cout << std::setw(42) << candidate.name;
+            for (std::size_t workload_idx = 0; workload_idx < workloads.size(); ++workload_idx) {
+                std::span<T const> const samples{samples_per_workload[workload_idx]};
+                T const zero = opaque_zero;
+                std::vector<double> measurements;
+                auto const run_once = [&] {
+                    if (!latency) {
+                        run_throughput_pass(candidate, config.dispatch, samples,
+                                            std::span<T>{trimmed_numbers},
+                                            std::span<std::size_t>{numbers_of_removed_zeros});
+                    }
+                    else if (config.dispatch == dispatch_mode::inlined) {
+                        (*candidate.inlined_dependent_loop)(samples, zero);
+                    }
+                    else {
+                        run_dependent_loop(candidate.candidate_function, samples, zero);
+                    }
+                };
+                repeat_measurements(
+                    config,
+                    [&] {
+                        measurements.push_back(measure_average_time_in_nanoseconds(
+                            run_once, samples.size(), config.min_duration_per_alg));
+                    },
+                    [&] { measurements.clear(); }, {&measurements}, bootstrap_rg);
+                auto const statistics = compute_statistics(measurements, bootstrap_rg);
+                medians[candidate_idx].push_back(statistics.median);
+                std::cout << std::setw(10) << statistics.median << std::flush;
+                records.push_back({std::size_t(std::numeric_limits<T>::digits), config.max_digits,
+                                   config.max_digits,
+                                   candidate.name + " @ " + workloads[workload_idx].label, metric,
+                                   measurements.size(), statistics, std::nullopt});
+            }
+            std::cout << "\n";
+        }
+
+        // The baseline does no work, so it cannot be the fastest.
+        std::cout << "Fastest:\n";
+        for (std::size_t workload_idx = 0; workload_idx < workloads.size(); ++workload_idx) {
+            std::size_t fastest = benchmark_candidates.size();
+            for (std::size_t candidate_idx = 1; candidate_idx < benchmark_candidates.size();
+                 ++candidate_idx) {
+                if (!medians[candidate_idx].empty() &&
+                    (fastest == benchmark_candidates.size() ||
+                     medians[candidate_idx][workload_idx] < medians[fastest][workload_idx])) {
+                    fastest = candidate_idx;
+                }
+            }
+            if (fastest != benchmark_candidates.size()) {
+                std::cout << std::setw(8) << workloads[workload_idx].label << ": "
+                          << benchmark_candidates[fastest].name << "\n";
+            }
+        }
+        std::cout << "\n";
+
+        if (plot_data != nullptr) {
+            auto& out = *plot_data;
+            out << "# " << std::numeric_limits<T>::digits << "-bit " << metric
+                << " in ns per sample\n\"workload\"\t\"entropy\"\t\"entropy rate\"";
+            for (std::size_t candidate_idx = 0; candidate_idx < benchmark_candidates.size();
+                 ++candidate_idx) {
+                if (!medians[candidate_idx].empty()) {
+                    out << "\t" << quote_csv(benchmark_candidates[candidate_idx].name);
+                }
+            }
+            out << "\n";
+            for (std::size_t workload_idx = 0; workload_idx < workloads.size(); ++workload_idx) {
+                out << workloads[workload_idx].label << "\t"
+                    << workloads[workload_idx].distribution_entropy << "\t"
+                    << workloads[workload_idx].entropy_rate;
+                for (auto const& candidate_medians : medians) {
+                    if (!candidate_medians.empty()) {
+                        out << "\t" << candidate_medians[workload_idx];
+                    }
+                }
+                out << "\n";
+            }
+            // Two blank lines separate the blocks gnuplot selects with index.
+            out << "\n\n";
+        }
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// Runs process_range(first, size) on number_of_threads contiguous ranges splitting [0, size) at
+// once, the first one on the calling thread, like the bulk API.
+template <class Function>
+void for_each_range_in_parallel(std::size_t size, std::size_t number_of_threads,
+                                Function const& process_range) {
+    auto const range_size = (size + number_of_threads - 1) / number_of_threads;
+    std::vector<std::thread> threads;
+    for (auto first = range_size; first < size; first += range_size) {
+        threads.emplace_back(
+            [&, first] { process_range(first, std::min(range_size, size - first)); });
+    }
+    process_range(0, std::min(range_size, size));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// One row of the bulk benchmark: a pass over the whole array, moving bytes_per_number bytes
+// from and to memory per number.
+struct bulk_benchmark_row {
+    std::string name;
+    double bytes_per_number = 0;
+    std::function<void(std::size_t number_of_threads)> run_pass;
+    // Whether the pass trims the array, which is then restored and verified.
+    bool trims = false;
+};
+
+// Times bulk::remove_trailing_zeros32/64 on an array much larger than the caches with every
+// combination of prefetching and non-temporal stores, on one thread and on all of them, against
+// STREAM-style loops over the same arrays. Bandwidths count the bytes the loops have to read
+// and write, not the cache lines read before being overwritten.
+template <class T>
+bool run_bulk_benchmark(command_line_options const& options, std::size_t default_max_digits,
+                        std::vector<result_record>& records) {
+    auto config = options.config;
+    config.max_digits = options.max_digits.value_or(default_max_digits);
+    auto const number_of_numbers = options.bulk_size_in_mib * (std::size_t(1) << 20) / sizeof(T);
+    std::cout << "[" << std::numeric_limits<T>::digits << "-bit bulk benchmark of "
+              << number_of_numbers << " numbers (" << options.bulk_size_in_mib << " MiB) with "
+              << config.min_digits << " to " << config.max_digits << " digits]\n\n";
+    if (auto const error = check_sample_distribution<T>(config.distribution, config.min_digits,
+                                                        config.max_digits);
+        !error.empty()) {
+        std::cout << "Error: " << error << ".\n";
+        return false;
+    }
+
+    auto const seed = config.seed ? *config.seed : generate_random_seed();
+    std::cout << "Generating samples (" << describe(config.distribution) << ", seed " << seed
+              << ")...\n";
+    print_sample_distribution_notes<T>(config.distribution, config.min_digits, config.max_digits);
+    auto const original = generate_random_samples<T>(number_of_numbers, config.min_digits,
+                                                     config.max_digits, config.distribution, seed);
+    auto const all_threads = std::max(std::size_t(std::thread::hardware_concurrency()),
+                                      std::size_t(1));
+
+    // Expected outputs of every pass that trims.
+    std::vector<T> expected_numbers(number_of_numbers);
+    std::vector<std::uint8_t> expected_numbers_of_removed_zeros(number_of_numbers);
+    for_each_range_in_parallel(number_of_numbers, all_threads, [&](std::size_t first,
+                                                                   std::size_t size) {
+        for (auto idx = first; idx < first + size; ++idx) {
+            auto const result = [&] {
+                if constexpr (std::is_same_v<T, std::uint32_t>) {
+                    return alg32::naive(original[idx]);
+                }
+                else {
+                    return alg64::naive(original[idx]);
+                }
+            }();
+            expected_numbers[idx] = result.trimmed_number;
+            expected_numbers_of_removed_zeros[idx] = std::uint8_t(result.number_of_removed_zeros);
+        }
+    });
+
+    std::vector<T> numbers(number_of_numbers);
+    std::vector<std::uint8_t> numbers_of_removed_zeros(number_of_numbers);
+    auto const copy_original = [&](std::size_t number_of_threads) {
+        for_each_range_in_parallel(number_of_numbers, number_of_threads,
+                                   [&](std::size_t first, std::size_t size) {
+                                       std::memcpy(numbers.data() + first, original.data() + first,
+                                                   size * sizeof(T));
+                                   });
+    };
+    // Before every pass that trims, untimed. The numbers of removed zeros are overwritten with a
+    // value no kernel returns, so that a pass leaving some of them unwritten cannot pass the check
+    // on what an earlier one wrote.
+    auto const reset_for_trimming = [&] {
+        for_each_range_in_parallel(number_of_numbers, all_threads,
+                                   [&](std::size_t first, std::size_t size) {
+                                       std::memcpy(numbers.data() + first, original.data() + first,
+                                                   size * sizeof(T));
+                                       std::memset(numbers_of_removed_zeros.data() + first, 0xff,
+                                                   size);
+                                   });
+    };
+    // After every pass that trims, untimed.
+    auto const check_trimming = [&] {
+        std::atomic<bool> correct = true;
+        for_each_range_in_parallel(
+            number_of_numbers, all_threads, [&](std::size_t first, std::size_t size) {
+                if (std::memcmp(numbers.data() + first, expected_numbers.data() + first,
+                                size * sizeof(T)) != 0 ||
+                    std::memcmp(numbers_of_removed_zeros.data() + first,
+                                expected_numbers_of_removed_zeros.data() + first, size) != 0) {
+                    correct.store(false, std::memory_order_relaxed);
+                }
+            });
+        return correct.load(std::memory_order_relaxed);
+    };
+
+    std::vector<bulk_benchmark_row> rows;
+    rows.push_back({"Copy (memcpy)", 2.0 * sizeof(T), copy_original});
+    rows.push_back({"Scale (b[i] = 3 * a[i])", 2.0 * sizeof(T), [&](std::size_t number_of_threads) {
+                        for_each_range_in_parallel(
+                            number_of_numbers, number_of_threads,
+                            [&](std::size_t first, std::size_t size) {
+                                for (auto idx = first; idx < first + size; ++idx) {
+                                    numbers[idx] = T(3 * original[idx]);
+                                }
+                            });
+                    }});
+    rows.push_back({"Scale in place (a[i] = 3 * a[i])", 2.0 * sizeof(T),
+                    [&](std::size_t number_of_threads) {
+                        for_each_range_in_parallel(
+                            number_of_numbers, number_of_threads,
+                            [&](std::size_t first, std::size_t size) {
+                                for (auto idx = first; idx < first + size; ++idx) {
+                                    numbers[idx] = T(3 * numbers[idx]);
+                                }
+                            });
+                    }});
+    auto const number_of_reference_rows = rows.size();
+    for (auto const non_temporal_stores : {false, true}) {
+        if (non_temporal_stores && !bulk::non_temporal_stores_available) {
+            continue;
+        }
+        for (auto const prefetch : {false, true}) {
+            bulk::options bulk_options;
+            bulk_options.non_temporal_stores = non_temporal_stores;
+            if (!prefetch) {
+                bulk_options.prefetch_distance = 0;
+            }
+            auto name = std::string{"Bulk"};
+            if (prefetch) {
+                name += " + prefetch";
+            }
+            if (non_temporal_stores) {
+                name += " + non-temporal stores";
+            }
+            rows.push_back({std::move(name), 2.0 * sizeof(T) + 1,
+                            [&, bulk_options](std::size_t number_of_threads) mutable {
+                                bulk_options.number_of_threads = number_of_threads;
+                                if constexpr (std::is_same_v<T, std::uint32_t>) {
+                                    bulk::remove_trailing_zeros32(numbers, numbers_of_removed_zeros,
+                                                                  bulk_options);
+                                }
+                                else {
+                                    bulk::remove_trailing_zeros64(numbers, numbers_of_removed_zeros,
+                                                                  bulk_options);
+                                }
+                            },
+                            true});
+        }
+    }
+
+    std::vector<std::size_t> thread_counts{1};
+    if (all_threads != 1) {
+        thread_counts.push_back(all_threads);
+    }
+
+    std::mt19937_64 bootstrap_rg;
+    // Medians in GB/s, for each row and thread count.
+    std::vector<std::vector<double>> bandwidths(rows.size());
+    std::cout << "Bandwidth in GB/s (median) and in percent of the fastest of the first "
+              << number_of_reference_rows << " rows (STREAM-style peak),\ncounting "
+              << 2 * sizeof(T) << " bytes per number for them and " << 2 * sizeof(T) + 1
+              << " bytes with the numbers of removed zeros for the bulk API:\n";
+    std::cout << std::setw(42) << "";
+    for (auto const number_of_threads : thread_counts) {
+        std::cout << std::setw(20)
+                  << (std::to_string(number_of_threads) +
+                      (number_of_threads == 1 ? " thread" : " threads"));
+    }
+    std::cout << "\n";
+    // The references are measured first, so that the percentages can be printed with the rows.
+    std::vector<double> peaks(thread_counts.size());
+    for (std::size_t row_idx = 0; row_idx < rows.size(); ++row_idx) {
+        auto const& row = rows[row_idx];
+        std::cout << std::setw(42) << row.name;
+        for (std::size_t thread_idx = 0; thread_idx < thread_counts.size(); ++thread_idx) {
+            auto const number_of_threads = thread_counts[thread_idx];
+            std::vector<double> measurements;
+            bool correct = true;
+            // Not converging is not reported, since the row is printed as it is measured.
+            repeat_measurements(
+                config,
+                [&] {
+                    if (row.trims) {
+                        reset_for_trimming();
+                    }
+                    auto const start_ticks = benchmark_timer.start();
+                    row.run_pass(number_of_threads);
+                    auto const ticks = benchmark_timer.stop() - start_ticks;
+                    measurements.push_back(benchmark_timer.to_nanoseconds(ticks) /
+                                           double(number_of_numbers));
+                    if (row.trims && !check_trimming()) {
+                        correct = false;
+                    }
+                },
+                [&] { measurements.clear(); }, {&measurements}, bootstrap_rg);
+            if (!correct) {
+                std::cout << "\nError detected in " << row.name << "!\n";
+                return false;
+            }
+
+            auto const statistics = compute_statistics(measurements, bootstrap_rg);
+            auto const bandwidth = row.bytes_per_number / statistics.median;
+            if (row_idx < number_of_reference_rows) {
+                peaks[thread_idx] = std::max(peaks[thread_idx], bandwidth);
+            }
+            bandwidths[row_idx].push_back(bandwidth);
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << bandwidth;
+            if (row_idx >= number_of_reference_rows) {
+                cell << " (" << std::setprecision(0) << 100 * bandwidth / peaks[thread_idx]
+                     << "%)";
+            }
+            std::cout << std::setw(20) << cell.str() << std::flush;
+            records.push_back({std::size_t(std::numeric_limits<T>::digits), config.min_digits,
+                               config.max_digits,
+                               row.name + ", " + std::to_string(number_of_threads) +
+                                   (number_of_threads == 1 ? " thread" : " threads"),
+                               "bulk", measurements.size(), statistics, std::nullopt});
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n\n";
+    return true;
+}
+
+int main(int argc, char** argv) {
+    command_line_options options;
+    if (!parse_command_line(argc, argv, options)) {
+        return 1;
+    }
+    if (options.show_help) {
+        std::cout << usage;
+        return 0;
+    }
+    if (!options.merge_paths.empty()) {
+        return print_merged_results(options.merge_paths) ? 0 : 1;
+    }
+    if (options.list_kernels) {
+        bool succeeded = true;
+        if (options.benchmark32) {
+            succeeded = list_kernels<std::uint32_t>(options, 8) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = list_kernels<std::uint64_t>(options, 16) && succeeded;
+        }
+#if defined(__SIZEOF_INT128__)
+        if (options.benchmark128) {
+            succeeded = list_kernels<wuint::builtin_uint128_t>(options, 34) && succeeded;
+        }
+#endif
+        return succeeded ? 0 : 1;
+    }
+    if (options.verification) {
+        bool succeeded = true;
+        if (options.benchmark32) {
+            succeeded = run_verification<std::uint32_t>(options, 8) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_verification<std::uint64_t>(options, 16) && succeeded;
+        }
+#if defined(__SIZEOF_INT128__)
+        if (options.benchmark128) {
+            succeeded = run_verification<wuint::builtin_uint128_t>(options, 34) && succeeded;
+        }
+#endif
+        return succeeded ? 0 : 1;
+    }
+    if (options.config.seed) {
+        std::cout << "Seed: " << *options.config.seed << "\n\n";
+    }
+    if ((options.pipeline || options.digit_count || options.entropy_sweep || options.bulk) &&
+        (options.config.hardware_counters || !options.config.cpus.empty() ||
+         options.config.l1_cold_block_size != 0 || options.config.cold_calls.enabled())) {
+        std::cerr << "--pipeline, --digit-count, --entropy-sweep and --bulk cannot be combined "
+                     "with --perf-counters, --cpus, --l1-cold or --cold-calls.\n";
+        return 1;
+    }
+    if (options.bulk &&
+        (!options.config.input_path.empty() || options.pipeline || options.digit_count ||
+         options.entropy_sweep || options.search_schedules ||
+         options.config.schedule == schedule_mode::interleaved)) {
+        std::cerr << "--bulk cannot be combined with --input, --pipeline, --digit-count, "
+                     "--entropy-sweep, --search-schedules or --schedule=interleaved.\n";
+        return 1;
+    }
+    if (options.entropy_sweep &&
+        (!options.config.input_path.empty() || options.pipeline || options.digit_count ||
+         options.search_schedules || options.config.schedule == schedule_mode::interleaved)) {
+        std::cerr << "--entropy-sweep cannot be combined with --input, --pipeline, --digit-count, "
+                     "--search-schedules or --schedule=interleaved.\n";
+        return 1;
+    }
+    if (!options.config.input_path.empty() && options.calibrate_dispatch) {
+        std::cerr << "--calibrate-dispatch cannot be combined with --input.\n";
+        return 1;
+    }
+    if ((options.pipeline || options.digit_count || !options.config.input_path.empty()) &&
+        options.config.schedule == schedule_mode::interleaved) {
+        std::cerr << "--schedule=interleaved cannot be combined with --pipeline, --digit-count or "
+                     "--input.\n";
+        return 1;
+    }
+    // Streamed samples are timed once per chunk and pass, not in repeated measurements.
+    if (!options.config.input_path.empty() && !options.pipeline &&
+        (options.config.target_relative_ci || options.config.warmup_runs != 0)) {
+        std::cerr << "--input cannot be combined with --target-ci or --warmup, except with "
+                     "--pipeline.\n";
+        return 1;
+    }
+    if (!options.config.input_path.empty() &&
+        (options.config.hardware_counters || !options.config.cpus.empty() ||
+         options.config.l1_cold_block_size != 0 || options.config.cold_calls.enabled())) {
+        std::cerr << "--input cannot be combined with --perf-counters, --cpus, --l1-cold or "
+                     "--cold-calls.\n";
+        return 1;
+    }
+    if (options.config.l1_cold_block_size != 0 &&
+        options.config.measurement == measurement_mode::latency) {
+        std::cerr << "--l1-cold requires throughput to be measured.\n";
+        return 1;
+    }
+    if (!options.config.cpus.empty()) {
+        if (options.config.measurement == measurement_mode::latency) {
+            std::cerr << "--cpus requires throughput to be measured.\n";
+            return 1;
+        }
+        std::cout << "Multi-threaded throughput on CPUs:";
+        for (auto const cpu : options.config.cpus) {
+            std::cout << " " << cpu;
+            if (auto const siblings = read_smt_siblings(cpu); !siblings.empty()) {
+                std::cout << " (SMT siblings " << siblings << ")";
+            }
         }
         std::cout << "\n\n";
     }
+
+    benchmark_timer = interval_timer::calibrate(options.timer);
+    std::cout << "Timing with " << benchmark_timer.name();
+    if (benchmark_timer.source() == timer_source::counter) {
+        std::cout << " at " << benchmark_timer.ticks_per_nanosecond() << " ticks per ns";
+    }
+    std::cout << ", " << benchmark_timer.overhead_ticks() << " ticks per pair of reads.\n\n";
+
+    // Read before benchmarking so that a bad baseline does not waste a whole run.
+    std::vector<result_record> baseline;
+    std::string baseline_distribution;
+    if (!options.baseline_path.empty()) {
+        std::ifstream file{options.baseline_path};
+        std::vector<std::pair<std::string, std::string>> baseline_metadata;
+        if (!file || !read_baseline(file, baseline, &baseline_metadata)) {
+            std::cerr << "Failed to read the baseline from " << options.baseline_path << "\n";
+            return 1;
+        }
+        auto const is_distribution = [](auto const& entry) { return entry.first == "distribution"; };
+        if (auto const it =
+                std::find_if(baseline_metadata.cbegin(), baseline_metadata.cend(), is_distribution);
+            it != baseline_metadata.cend()) {
+            baseline_distribution = it->second;
+        }
+    }
+
+    std::vector<result_record> records;
+    bool succeeded = true;
+    if (options.pipeline) {
+        if (options.benchmark32) {
+            succeeded = run_pipeline_benchmark<std::uint32_t>(options, 8, records) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_pipeline_benchmark<std::uint64_t>(options, 16, records) && succeeded;
+        }
+    }
+    else if (options.entropy_sweep) {
+        std::ofstream plot_data;
+        if (!options.sweep_data_path.empty()) {
+            // Opened before sweeping so that a bad path does not waste a whole sweep.
+            plot_data.open(options.sweep_data_path);
+            if (!plot_data) {
+                std::cerr << "Failed to open " << options.sweep_data_path << "\n";
+                return 1;
+            }
+        }
+        auto const plot_data_ptr = plot_data.is_open() ? &plot_data : nullptr;
+        if (options.benchmark32) {
+            succeeded = run_entropy_sweep<std::uint32_t>(options, 8, records, plot_data_ptr) &&
+                        succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_entropy_sweep<std::uint64_t>(options, 16, records, plot_data_ptr) &&
+                        succeeded;
+        }
+#if defined(__SIZEOF_INT128__)
+        if (options.benchmark128) {
+            succeeded =
+                run_entropy_sweep<wuint::builtin_uint128_t>(options, 34, records, plot_data_ptr) &&
+                succeeded;
+        }
+#endif
+        if (!options.sweep_data_path.empty() && !plot_data) {
+            std::cerr << "Failed to write " << options.sweep_data_path << "\n";
+            succeeded = false;
+        }
+    }
+    else if (options.bulk) {
+        if (options.benchmark32) {
+            succeeded = run_bulk_benchmark<std::uint32_t>(options, 8, records) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_bulk_benchmark<std::uint64_t>(options, 16, records) && succeeded;
+        }
+    }
+    else if (options.digit_count) {
+        if (options.benchmark32) {
+            succeeded = run_digit_count_benchmark<std::uint32_t>(options, 8, records) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_digit_count_benchmark<std::uint64_t>(options, 16, records) && succeeded;
+        }
+    }
+    else {
+        if (options.benchmark32) {
+            succeeded = run_benchmark<std::uint32_t>(options, 8, records) && succeeded;
+        }
+        if (options.benchmark64) {
+            succeeded = run_benchmark<std::uint64_t>(options, 16, records) && succeeded;
+        }
+#if defined(__SIZEOF_INT128__)
+        if (options.benchmark128) {
+            succeeded = run_benchmark<wuint::builtin_uint128_t>(options, 34, records) && succeeded;
+        }
+#endif
+    }
+
+    auto const metadata = collect_run_metadata(options.config);
+    auto const write_output = [&](std::string const& path, auto&& write) {
+        if (path.empty()) {
+            return;
+        }
+        std::ofstream file{path};
+        write(file, metadata, records);
+        if (!file) {
+            std::cerr << "Failed to write " << path << "\n";
+            succeeded = false;
+        }
+    };
+    write_output(options.csv_path, write_csv);
+    write_output(options.json_path, write_json);
+
+    if (!options.baseline_path.empty() &&
+        !compare_with_baseline(records, baseline, describe_samples(options.config),
+                               baseline_distribution, options.regression_threshold_percent)) {
+        return 2;
+    }
+    return succeeded ? 0 : 1;
 }